@@ -0,0 +1,167 @@
+// agent_world.h
+// Many agents exploring one shared dungeon, ticked in parallel on a
+// work-stealing pool (the server side of the dungeon game)
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+
+#include "dungeon.h"
+#include "work_stealing.h"
+#include "rng.h"
+
+// ============ AGENT WORLD ============
+
+const uint32_t AGENT_CHUNK = 256; // agents per pool task
+const uint32_t AGENT_TRAIL = 8;   // rooms of backtrack history per agent
+
+struct AgentTickStats {
+    uint64_t moves = 0;
+    uint64_t backtracks = 0;
+    uint64_t hits = 0;
+    uint64_t kills = 0;
+    uint64_t treasures = 0;
+    uint64_t deaths = 0;
+    
+    void merge(const AgentTickStats& o) {
+        moves += o.moves;
+        backtracks += o.backtracks;
+        hits += o.hits;
+        kills += o.kills;
+        treasures += o.treasures;
+        deaths += o.deaths;
+    }
+};
+
+// Same rules as DungeonGame, one step per agent per tick: fight the
+// monster in the room if it is alive, otherwise walk (sometimes back the
+// way it came) and pick up any treasure there.
+//
+// Sharing:
+//   - DungeonGraph is read-only while ticking and read with no locking.
+//   - Agent state is split into chunks; only the thread running a chunk
+//     touches its agents, so it needs no synchronization either.
+//   - Monster HP and treasure are the only contested state. A hit is one
+//     fetch_sub, and the agent that takes HP from above 0 to 0 or below
+//     gets the kill. A pickup is one exchange, so each treasure is taken
+//     exactly once however many agents arrive in the same tick.
+//
+// Each agent has its own random stream, but who lands the kill on a
+// contested monster depends on thread timing, so multi-threaded runs are
+// not bit-for-bit repeatable.
+class AgentWorld {
+public:
+    AgentWorld(const DungeonGraph& d, const std::vector<int>& monsterHealth, uint32_t agents,
+               uint64_t seed, uint32_t startRoom = 0)
+        : dungeon(d), rooms((uint32_t)d.roomCount()),
+          monsterHp(new std::atomic<int>[rooms]), treasure(new std::atomic<uint8_t>[rooms]) {
+        for (uint32_t r = 0; r < rooms; r++) {
+            monsterHp[r].store(d.hasMonster[r] && r < monsterHealth.size() ? monsterHealth[r] : 0,
+                               std::memory_order_relaxed);
+            treasure[r].store(d.hasTreasure[r], std::memory_order_relaxed);
+        }
+        room.assign(agents, startRoom);
+        health.assign(agents, 100);
+        gold.assign(agents, 0);
+        attack.assign(agents, 10);
+        trail.assign((size_t)agents * AGENT_TRAIL, 0);
+        trailTop.assign(agents, 0);
+        trailDepth.assign(agents, 0);
+        rngs.reserve(agents);
+        for (uint32_t a = 0; a < agents; a++) rngs.emplace_back(seed, a);
+    }
+    
+    uint32_t agentCount() const { return (uint32_t)room.size(); }
+    uint32_t roomOf(uint32_t a) const { return room[a]; }
+    int healthOf(uint32_t a) const { return health[a]; }
+    int goldOf(uint32_t a) const { return gold[a]; }
+    
+    // Safe to call between ticks
+    bool monsterAlive(uint32_t r) const { return monsterHp[r].load(std::memory_order_relaxed) > 0; }
+    bool treasureLeft(uint32_t r) const { return treasure[r].load(std::memory_order_relaxed) != 0; }
+    
+    AgentTickStats tick(WorkStealingPool& pool) {
+        perThread.assign(pool.threadCount(), PaddedStats());
+        uint32_t chunks = (agentCount() + AGENT_CHUNK - 1) / AGENT_CHUNK;
+        pool.run(chunks, [&](uint32_t chunk, unsigned thread) {
+            AgentTickStats& stats = perThread[thread].stats;
+            uint32_t last = std::min(agentCount(), (chunk + 1) * AGENT_CHUNK);
+            for (uint32_t a = chunk * AGENT_CHUNK; a < last; a++) step(a, stats);
+        });
+        
+        AgentTickStats total;
+        for (auto& p : perThread) total.merge(p.stats);
+        return total;
+    }
+    
+private:
+    const DungeonGraph& dungeon;
+    uint32_t rooms;
+    std::unique_ptr<std::atomic<int>[]> monsterHp;
+    std::unique_ptr<std::atomic<uint8_t>[]> treasure;
+    
+    // Agent state, structure of arrays
+    std::vector<uint32_t> room;
+    std::vector<int> health;
+    std::vector<int> gold;
+    std::vector<int> attack;
+    std::vector<uint32_t> trail;     // AGENT_TRAIL rooms per agent, used as a ring
+    std::vector<uint32_t> trailTop;  // pushes minus pops
+    std::vector<uint8_t> trailDepth; // rooms we can still go back to
+    std::vector<Rng> rngs;
+    
+    // One per thread, each on its own cache line
+    struct alignas(64) PaddedStats {
+        AgentTickStats stats;
+    };
+    std::vector<PaddedStats> perThread;
+    
+    void step(uint32_t a, AgentTickStats& stats) {
+        if (health[a] <= 0) return;
+        Rng& rng = rngs[a];
+        uint32_t here = room[a];
+        
+        if (monsterHp[here].load(std::memory_order_relaxed) > 0) {
+            int damage = attack[a] + (int)rng.below(10);
+            int before = monsterHp[here].fetch_sub(damage, std::memory_order_relaxed);
+            if (before > 0) {
+                stats.hits++;
+                if (before <= damage) {
+                    stats.kills++;
+                    gold[a] += 10 + (int)rng.below(15);
+                } else {
+                    health[a] -= 5 + (int)rng.below(10);
+                    if (health[a] <= 0) stats.deaths++;
+                }
+                return;
+            }
+            // Someone else killed it first this tick; walk on
+        }
+        
+        uint32_t next;
+        uint32_t* ring = &trail[(size_t)a * AGENT_TRAIL];
+        if (trailDepth[a] > 0 && rng.chance(10)) {
+            trailTop[a]--;
+            trailDepth[a]--;
+            next = ring[trailTop[a] % AGENT_TRAIL];
+            stats.backtracks++;
+        } else {
+            CsrGraph::Range exits = dungeon.connections(here);
+            if (exits.empty()) return;
+            next = exits[rng.below((uint32_t)exits.size())];
+            ring[trailTop[a] % AGENT_TRAIL] = here;
+            trailTop[a]++;
+            trailDepth[a] = (uint8_t)std::min<uint32_t>(trailDepth[a] + 1, AGENT_TRAIL);
+            stats.moves++;
+        }
+        room[a] = next;
+        
+        if (treasure[next].load(std::memory_order_relaxed) && treasure[next].exchange(0, std::memory_order_relaxed)) {
+            stats.treasures++;
+            gold[a] += 20 + (int)rng.below(30);
+        }
+    }
+};
@@ -0,0 +1,223 @@
+// autocomplete.h
+// TRIE - Radix trie for prefix search with top-k ranking by weight
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <queue>
+#include <cstdint>
+#include <cctype>
+
+// Names are sorted once and stored back to back in a single character pool.
+// Every trie node covers a contiguous range of that sorted order, so a
+// prefix walk ends in a range [lo, hi) and the top-k is a range-max query
+// over the weights, answered by a segment tree in O(k log k log n).
+class Autocomplete {
+public:
+    // Stage a name before build(); value is the caller's id for it
+    void add(std::string_view name, uint32_t value, uint32_t weight = 0) {
+        staged.push_back({lowered(name), value, weight});
+    }
+    
+    void build() {
+        std::sort(staged.begin(), staged.end(), [](const Entry& a, const Entry& b) {
+            return a.key < b.key;
+        });
+        
+        size_t n = staged.size();
+        keyStart.assign(n + 1, 0);
+        values.resize(n);
+        pool.clear();
+        uint32_t maxValue = 0;
+        for (size_t i = 0; i < n; i++) {
+            keyStart[i] = (uint32_t)pool.size();
+            pool += staged[i].key;
+            values[i] = staged[i].value;
+            maxValue = std::max(maxValue, staged[i].value);
+        }
+        keyStart[n] = (uint32_t)pool.size();
+        
+        positionOf.assign(n ? maxValue + 1 : 0, NONE);
+        for (size_t i = 0; i < n; i++) positionOf[values[i]] = (uint32_t)i;
+        
+        // Segment tree of argmax over weights, leaves at [leaves, 2*leaves)
+        leaves = 1;
+        while (leaves < n) leaves *= 2;
+        weights.assign(leaves, 0);
+        best.assign(2 * leaves, NONE);
+        for (size_t i = 0; i < n; i++) {
+            weights[i] = staged[i].weight;
+            best[leaves + i] = (uint32_t)i;
+        }
+        for (size_t i = leaves - 1; i >= 1; i--) best[i] = better(best[2 * i], best[2 * i + 1]);
+        
+        nodes.clear();
+        nodes.push_back({0, 0, 0, 0, 0, (uint32_t)n});
+        if (n > 0) buildNode(0, 0);
+        
+        staged.clear();
+        staged.shrink_to_fit();
+    }
+    
+    size_t size() const { return values.size(); }
+    
+    void setWeight(uint32_t value, uint32_t weight) {
+        if (value >= positionOf.size() || positionOf[value] == NONE) return;
+        size_t i = positionOf[value];
+        weights[i] = weight;
+        for (i = (leaves + i) / 2; i >= 1; i /= 2) best[i] = better(best[2 * i], best[2 * i + 1]);
+    }
+    
+    uint32_t weightOf(uint32_t value) const {
+        if (value >= positionOf.size() || positionOf[value] == NONE) return 0;
+        return weights[positionOf[value]];
+    }
+    
+    // Up to k values whose names start with prefix (case-insensitive),
+    // heaviest first; ties go to the alphabetically first name
+    std::vector<uint32_t> topK(std::string_view prefix, size_t k) const {
+        std::vector<uint32_t> out;
+        uint32_t lo, hi;
+        if (k == 0 || !findRange(prefix, lo, hi)) return out;
+        
+        struct Span {
+            uint32_t weight, pos, lo, hi;
+            bool operator<(const Span& o) const {
+                return weight != o.weight ? weight < o.weight : pos > o.pos;
+            }
+        };
+        std::priority_queue<Span> spans;
+        auto pushSpan = [&](uint32_t l, uint32_t h) {
+            if (l >= h) return;
+            uint32_t p = rangeBest(l, h);
+            spans.push({weights[p], p, l, h});
+        };
+        
+        pushSpan(lo, hi);
+        while (!spans.empty() && out.size() < k) {
+            Span s = spans.top();
+            spans.pop();
+            out.push_back(values[s.pos]);
+            pushSpan(s.lo, s.pos);
+            pushSpan(s.pos + 1, s.hi);
+        }
+        return out;
+    }
+    
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+    
+    struct Entry {
+        std::string key;
+        uint32_t value;
+        uint32_t weight;
+    };
+    
+    // Edge label is pool[labelStart, labelStart + labelLen); children are
+    // nodes[firstChild, firstChild + childCount), sorted by first character
+    struct Node {
+        uint32_t labelStart, labelLen;
+        uint32_t firstChild, childCount;
+        uint32_t lo, hi;
+    };
+    
+    std::vector<Entry> staged;
+    std::string pool;               // sorted, lowercased names back to back
+    std::vector<uint32_t> keyStart; // name i is pool[keyStart[i], keyStart[i+1])
+    std::vector<uint32_t> values;
+    std::vector<uint32_t> positionOf;
+    std::vector<uint32_t> weights;
+    std::vector<uint32_t> best;
+    size_t leaves = 1;
+    std::vector<Node> nodes;
+    
+    static std::string lowered(std::string_view s) {
+        std::string out(s);
+        for (char& c : out) c = (char)std::tolower((unsigned char)c);
+        return out;
+    }
+    
+    size_t keyLength(uint32_t i) const { return keyStart[i + 1] - keyStart[i]; }
+    char keyAt(uint32_t i, size_t d) const { return pool[keyStart[i] + d]; }
+    
+    uint32_t better(uint32_t a, uint32_t b) const {
+        if (a == NONE) return b;
+        if (b == NONE) return a;
+        return weights[b] > weights[a] ? b : a;
+    }
+    
+    uint32_t rangeBest(uint32_t lo, uint32_t hi) const {
+        // Separate left and right accumulators keep ties on the leftmost name
+        uint32_t left = NONE, right = NONE;
+        for (size_t l = lo + leaves, h = hi + leaves; l < h; l /= 2, h /= 2) {
+            if (l & 1) left = better(left, best[l++]);
+            if (h & 1) right = better(best[--h], right);
+        }
+        return better(left, right);
+    }
+    
+    // Node covering sorted names [lo, hi) that all share depth characters.
+    // Its label runs to their longest common prefix; children split on the
+    // next character. Names ending at the label stay in the node's range.
+    void buildNode(uint32_t id, size_t depth) {
+        uint32_t lo = nodes[id].lo, hi = nodes[id].hi;
+        size_t common = std::min(keyLength(lo), keyLength(hi - 1));
+        size_t end = depth;
+        while (end < common && keyAt(lo, end) == keyAt(hi - 1, end)) end++;
+        nodes[id].labelStart = keyStart[lo] + (uint32_t)depth;
+        nodes[id].labelLen = (uint32_t)(end - depth);
+        
+        uint32_t first = lo;
+        while (first < hi && keyLength(first) == end) first++;
+        
+        std::vector<std::pair<uint32_t, uint32_t>> groups;
+        for (uint32_t i = first; i < hi;) {
+            uint32_t j = i + 1;
+            while (j < hi && keyAt(j, end) == keyAt(i, end)) j++;
+            groups.push_back({i, j});
+            i = j;
+        }
+        
+        uint32_t base = (uint32_t)nodes.size();
+        nodes[id].firstChild = base;
+        nodes[id].childCount = (uint32_t)groups.size();
+        for (auto& g : groups) nodes.push_back({0, 0, 0, 0, g.first, g.second});
+        for (size_t c = 0; c < groups.size(); c++) buildNode(base + (uint32_t)c, end);
+    }
+    
+    bool findRange(std::string_view prefix, uint32_t& lo, uint32_t& hi) const {
+        if (values.empty()) return false;
+        uint32_t id = 0;
+        size_t i = 0;
+        while (true) {
+            const Node& node = nodes[id];
+            for (uint32_t j = 0; j < node.labelLen; j++, i++) {
+                if (i == prefix.size()) {
+                    lo = node.lo;
+                    hi = node.hi;
+                    return true;
+                }
+                if (pool[node.labelStart + j] != (char)std::tolower((unsigned char)prefix[i])) return false;
+            }
+            if (i == prefix.size()) {
+                lo = node.lo;
+                hi = node.hi;
+                return true;
+            }
+            
+            char c = (char)std::tolower((unsigned char)prefix[i]);
+            uint32_t next = NONE;
+            for (uint32_t k = 0; k < node.childCount; k++) {
+                const Node& child = nodes[node.firstChild + k];
+                if (pool[child.labelStart] == c) {
+                    next = node.firstChild + k;
+                    break;
+                }
+            }
+            if (next == NONE) return false;
+            id = next;
+        }
+    }
+};
@@ -0,0 +1,258 @@
+// battle_sim.cpp
+// Headless battle simulator for balance testing. Runs N independent
+// hero-vs-group fights per enemy level using the rules in combat.h and
+// reports win rate, turns-to-kill and the hero's remaining HP.
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "combat.h"
+#include "rng.h"
+
+using namespace std;
+
+// ============ SIMULATION ============
+
+const size_t CHUNK = 4096; // battles per work item
+const int HP_BUCKETS = 10; // remaining HP in tenths of max; bucket 0 = dead
+
+struct SimOptions {
+    long long battles = 100000;
+    int minLevel = 1;
+    int maxLevel = 7;
+    int heroLevel = 1;
+    int group = 1; // enemies per battle
+    int maxTurns = 1000;
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    uint64_t seed = 12345;
+};
+
+struct LevelReport {
+    long long battles = 0;
+    long long wins = 0;
+    long long winTurns = 0;
+    vector<long long> turnsToKill; // histogram, index = turns
+    long long hpBuckets[HP_BUCKETS + 1] = {};
+    
+    void merge(const LevelReport& other) {
+        battles += other.battles;
+        wins += other.wins;
+        winTurns += other.winTurns;
+        if (turnsToKill.size() < other.turnsToKill.size()) {
+            turnsToKill.resize(other.turnsToKill.size(), 0);
+        }
+        for (size_t t = 0; t < other.turnsToKill.size(); t++) {
+            turnsToKill[t] += other.turnsToKill[t];
+        }
+        for (int b = 0; b <= HP_BUCKETS; b++) hpBuckets[b] += other.hpBuckets[b];
+    }
+    
+    int turnPercentile(double p) const {
+        long long want = (long long)(p * wins);
+        long long seen = 0;
+        for (size_t t = 0; t < turnsToKill.size(); t++) {
+            seen += turnsToKill[t];
+            if (seen > want) return (int)t;
+        }
+        return 0;
+    }
+};
+
+// Turns come from the same BattleScheduler the game uses: the hero
+// attacks the front enemy on its turns (onAttack), every standing enemy
+// hits the hero on theirs (enemyTurn). Every battle in the chunk has the
+// same speeds and so the same turn order, so they advance in lockstep on
+// structure-of-arrays stats. Enemy unit g of battle i is index
+// g * count + i, so each unit's pass over the chunk is contiguous.
+// turns counts the hero's actions.
+void simulateChunk(const SimOptions& opt, int enemyLevel, size_t count,
+                   Rng& rng, LevelReport& report) {
+    CombatStats heroStats = heroStatsForLevel(opt.heroLevel);
+    CombatStats enemyStats = enemyGroupStatsForLevel(enemyLevel, opt.group);
+    size_t group = (size_t)opt.group;
+    CombatantBatch hero, enemy;
+    hero.assign(count, heroStats);
+    enemy.assign(count * group, enemyStats);
+    
+    vector<int> roll(count);
+    vector<int> active(count, 1);
+    vector<int> attacking(count);
+    vector<int> turns(count, 0);
+    vector<uint32_t> front(count, 0); // first standing unit of each battle
+    vector<int> targetHp(count), targetDefense(count);
+    
+    // One hero and one group leader stand in for every battle's turn order:
+    // the group's units share a speed, so their turns land together
+    CombatantBatch heroSide, enemySide;
+    heroSide.assign(1, heroStats);
+    enemySide.assign(1, enemyStats);
+    BattleScheduler order;
+    order.start(heroSide, enemySide);
+    size_t live = count;
+    for (int turn = 0; turn < opt.maxTurns && live > 0;) {
+        BattleTurn next = order.next();
+        if (next.side == SIDE_HERO) {
+            turn++;
+            for (size_t i = 0; i < count; i++) {
+                turns[i] += active[i];
+                roll[i] = rng.below(PLAYER_ATTACK_SPREAD);
+                size_t target = min<size_t>(front[i], group - 1) * count + i;
+                targetHp[i] = enemy.hp[target];
+                targetDefense[i] = enemy.defense[target];
+            }
+            resolveAttacks(hero.attack.data(), roll.data(), active.data(),
+                           targetDefense.data(), targetHp.data(), count);
+            for (size_t i = 0; i < count; i++) {
+                if (!active[i]) continue;
+                enemy.hp[front[i] * count + i] = targetHp[i];
+                while (front[i] < group && enemy.hp[front[i] * count + i] == 0) front[i]++;
+            }
+        } else {
+            for (size_t g = 0; g < group; g++) {
+                const int* hp = &enemy.hp[g * count];
+                for (size_t i = 0; i < count; i++) {
+                    roll[i] = rng.below(ENEMY_ATTACK_SPREAD);
+                    attacking[i] = active[i] & (hp[i] > 0);
+                }
+                resolveAttacks(&enemy.attack[g * count], roll.data(), attacking.data(),
+                               hero.defense.data(), hero.hp.data(), count);
+            }
+        }
+        order.schedule(next.side, next.speed);
+        
+        live = 0;
+        for (size_t i = 0; i < count; i++) {
+            active[i] &= front[i] < group && hero.hp[i] > 0;
+            live += active[i];
+        }
+    }
+    
+    report.battles += count;
+    if (report.turnsToKill.size() < (size_t)opt.maxTurns + 1) {
+        report.turnsToKill.resize(opt.maxTurns + 1, 0);
+    }
+    for (size_t i = 0; i < count; i++) {
+        bool won = front[i] == group;
+        if (won) {
+            report.wins++;
+            report.winTurns += turns[i];
+            report.turnsToKill[turns[i]]++;
+        }
+        int bucket = hero.hp[i] == 0 ? 0
+            : 1 + min(HP_BUCKETS - 1, hero.hp[i] * HP_BUCKETS / (hero.maxHp[i] + 1));
+        report.hpBuckets[bucket]++;
+    }
+}
+
+vector<LevelReport> runSimulation(const SimOptions& opt) {
+    int levels = opt.maxLevel - opt.minLevel + 1;
+    long long chunksPerLevel = (opt.battles + CHUNK - 1) / CHUNK;
+    long long totalChunks = chunksPerLevel * levels;
+    
+    atomic<long long> nextChunk(0);
+    vector<vector<LevelReport>> perThread(opt.threads, vector<LevelReport>(levels));
+    
+    auto worker = [&](unsigned t) {
+        while (true) {
+            long long c = nextChunk.fetch_add(1);
+            if (c >= totalChunks) break;
+            int levelIndex = (int)(c / chunksPerLevel);
+            long long chunk = c % chunksPerLevel;
+            size_t count = (size_t)min<long long>(CHUNK, opt.battles - chunk * (long long)CHUNK);
+            
+            // Seeded per chunk so results do not depend on the thread count
+            Rng rng(opt.seed, ((uint64_t)levelIndex << 32) | (uint64_t)chunk);
+            simulateChunk(opt, opt.minLevel + levelIndex, count, rng, perThread[t][levelIndex]);
+        }
+    };
+    
+    vector<thread> pool;
+    for (unsigned t = 0; t < opt.threads; t++) pool.emplace_back(worker, t);
+    for (auto& th : pool) th.join();
+    
+    vector<LevelReport> reports(levels);
+    for (auto& local : perThread) {
+        for (int l = 0; l < levels; l++) reports[l].merge(local[l]);
+    }
+    return reports;
+}
+
+// ============ COMMAND LINE ============
+
+void printUsage() {
+    cout << "Usage: battle_sim [--battles N] [--levels MIN-MAX] [--hero-level L]\n"
+         << "                  [--group N] [--max-turns T] [--threads T] [--seed S]\n";
+}
+
+bool parseOptions(int argc, char* argv[], SimOptions& opt) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--battles" && hasValue) {
+            opt.battles = atoll(argv[++i]);
+        } else if (arg == "--levels" && hasValue) {
+            if (sscanf(argv[++i], "%d-%d", &opt.minLevel, &opt.maxLevel) == 1) {
+                opt.maxLevel = opt.minLevel;
+            }
+        } else if (arg == "--hero-level" && hasValue) {
+            opt.heroLevel = atoi(argv[++i]);
+        } else if (arg == "--group" && hasValue) {
+            opt.group = atoi(argv[++i]);
+        } else if (arg == "--max-turns" && hasValue) {
+            opt.maxTurns = atoi(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            opt.threads = (unsigned)max(1, atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            opt.seed = strtoull(argv[++i], nullptr, 10);
+        } else {
+            return false;
+        }
+    }
+    return opt.battles > 0 && opt.minLevel >= 1 && opt.maxLevel >= opt.minLevel
+        && opt.heroLevel >= 1 && opt.group >= 1 && opt.group <= (int)MAX_ENEMY_GROUP
+        && opt.maxTurns > 0;
+}
+
+int main(int argc, char* argv[]) {
+    SimOptions opt;
+    if (!parseOptions(argc, argv, opt)) {
+        printUsage();
+        return 1;
+    }
+    
+    auto start = chrono::steady_clock::now();
+    vector<LevelReport> reports = runSimulation(opt);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    printf("Hero level %d vs %d enem%s, %lld battles per enemy level, %u threads\n\n",
+           opt.heroLevel, opt.group, opt.group == 1 ? "y" : "ies", opt.battles, opt.threads);
+    printf("Lvl   Win%%  AvgTurns  p50  p90 | Hero HP left (%% of battles, by %% of max HP)\n");
+    printf("                               |  dead");
+    for (int b = 1; b <= HP_BUCKETS; b++) printf(" %4d%%", b * 100 / HP_BUCKETS);
+    printf("\n");
+    
+    long long total = 0;
+    for (size_t l = 0; l < reports.size(); l++) {
+        const LevelReport& r = reports[l];
+        total += r.battles;
+        double avgTurns = r.wins ? (double)r.winTurns / r.wins : 0.0;
+        printf("%3d  %5.1f  %8.2f  %3d  %3d | %5.1f",
+               opt.minLevel + (int)l, 100.0 * r.wins / r.battles, avgTurns,
+               r.turnPercentile(0.5), r.turnPercentile(0.9),
+               100.0 * r.hpBuckets[0] / r.battles);
+        for (int b = 1; b <= HP_BUCKETS; b++) printf(" %5.1f", 100.0 * r.hpBuckets[b] / r.battles);
+        printf("\n");
+    }
+    
+    printf("\n%lld battles in %.3f s (%.2f M battles/s)\n", total, seconds, total / seconds / 1e6);
+    return 0;
+}
+
+// Compile with: g++ -O3 -march=native -std=c++17 -pthread battle_sim.cpp -o battle_sim
@@ -0,0 +1,454 @@
+// benchmarks.cpp
+// Micro-benchmarks for the hot paths of both games, at several world sizes.
+// One JSON object per line on stdout, so nightly runs can diff them.
+#include <iostream>
+#include <vector>
+#include <string>
+#include <queue>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "dungeon.h"
+#include "distance_field.h"
+#include "ring_buffer.h"
+#include "skill_tree.h"
+#include "combat.h"
+#include "rng.h"
+
+#if !defined(BENCH_NO_RENDER)
+#include "render_batch.h"
+#endif
+
+using namespace std;
+
+// ============ HARNESS ============
+
+struct BenchOptions {
+    vector<int> sizes = {10, 1000, 100000, 1000000};
+    string filter;           // run only benchmarks whose name contains this
+    double minSeconds = 0.2; // per measurement
+    int repeats = 3;         // best of
+    uint64_t seed = 12345;
+};
+
+BenchOptions opt;
+
+// Keeps results alive so the optimizer cannot drop the work
+volatile uint64_t sink;
+
+// body(n) runs n operations. The count doubles until one run takes
+// minSeconds; the best ns/op of `repeats` such runs is reported.
+void measure(const string& name, int size, const function<void(uint64_t)>& body) {
+    if (!opt.filter.empty() && name.find(opt.filter) == string::npos) return;
+    
+    uint64_t ops = 1;
+    double seconds = 0;
+    while (true) {
+        auto start = chrono::steady_clock::now();
+        body(ops);
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (seconds >= opt.minSeconds || ops >= (1ull << 40)) break;
+        ops *= 2;
+    }
+    
+    double best = seconds;
+    for (int r = 1; r < opt.repeats; r++) {
+        auto start = chrono::steady_clock::now();
+        body(ops);
+        best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    printf("{\"name\":\"%s\",\"size\":%d,\"ops\":%llu,\"ns_per_op\":%.2f,\"ops_per_sec\":%.0f}\n",
+           name.c_str(), size, (unsigned long long)ops, best * 1e9 / ops, ops / best);
+    fflush(stdout);
+}
+
+void skipped(const string& name, int size, const char* why) {
+    if (!opt.filter.empty() && name.find(opt.filter) == string::npos) return;
+    printf("{\"name\":\"%s\",\"size\":%d,\"skipped\":\"%s\"}\n", name.c_str(), size, why);
+}
+
+// ============ DUNGEON GRAPH ============
+
+// Same layout the game's --generate option produces
+void makeDungeon(DungeonGraph& dungeon, int rooms) {
+    vector<int> monsterHealth;
+    generateDungeon(dungeon, monsterHealth, max(rooms, MIN_GENERATED_ROOMS), opt.seed, 1);
+    dungeon.freeze();
+}
+
+void benchGraph(int size) {
+    DungeonGraph source;
+    makeDungeon(source, size);
+    const auto& corridors = source.builder.edges;
+    
+    // One op = one connectRooms call; the graph is rebuilt from scratch
+    // every `corridors.size()` calls, like a world load
+    measure("graph.connect_rooms", size, [&](uint64_t ops) {
+        DungeonGraph d;
+        for (int id = 0; id < source.roomCount(); id++) {
+            d.addRoom(id, source.names[id], source.positions[id].first, source.positions[id].second);
+        }
+        for (uint64_t i = 0; i < ops; i++) {
+            size_t k = i % corridors.size();
+            if (k == 0) d.builder = GraphBuilder();
+            d.connectRooms(corridors[k].first, corridors[k].second);
+        }
+        sink = d.builder.edges.size();
+    });
+    
+    measure("graph.freeze", size, [&](uint64_t ops) {
+        DungeonGraph d = source;
+        for (uint64_t i = 0; i < ops; i++) d.freeze();
+        sink = d.graph.arcCount();
+    });
+    
+    // Half the queried pairs are adjacent, half are random
+    Rng rng(opt.seed, 1);
+    const int QUERIES = 4096;
+    vector<pair<int, int>> pairs(QUERIES);
+    for (auto& q : pairs) {
+        const auto& e = corridors[rng.below((uint32_t)corridors.size())];
+        q = rng.chance(50) ? make_pair((int)e.first, (int)e.second)
+            : make_pair((int)rng.below(source.roomCount()), (int)rng.below(source.roomCount()));
+    }
+    measure("graph.are_connected", size, [&](uint64_t ops) {
+        uint64_t hits = 0;
+        for (uint64_t i = 0; i < ops; i++) {
+            const auto& q = pairs[i % QUERIES];
+            hits += source.areConnected(q.first, q.second);
+        }
+        sink = hits;
+    });
+    
+    measure("graph.neighbors", size, [&](uint64_t ops) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < ops; i++) {
+            for (uint32_t v : source.connections(pairs[i % QUERIES].first)) total += v;
+        }
+        sink = total;
+    });
+    
+    measure("graph.find_path", size, [&](uint64_t ops) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < ops; i++) {
+            const auto& q = pairs[i % QUERIES];
+            total += source.findPath(q.first, q.second).path.size();
+        }
+        sink = total;
+    });
+    
+    // Treasure field over the whole map, a bounded danger map around one
+    // room, and the 16-hop scout DungeonGame::scout runs around the player
+    vector<uint32_t> treasures;
+    for (int id = 0; id < source.roomCount(); id++) {
+        if (source.hasTreasure[id]) treasures.push_back(id);
+    }
+    DistanceField field;
+    measure("graph.distance_field", size, [&](uint64_t ops) {
+        for (uint64_t i = 0; i < ops; i++) field.compute(source.graph, treasures);
+        sink = field.hopsTo(0);
+    });
+    measure("graph.distance_field_3_hops", size, [&](uint64_t ops) {
+        for (uint64_t i = 0; i < ops; i++) field.compute(source.graph, (uint32_t)pairs[i % QUERIES].first, 3);
+        sink = field.hopsTo(0);
+    });
+    measure("graph.distance_field_16_hops", size, [&](uint64_t ops) {
+        for (uint64_t i = 0; i < ops; i++) field.compute(source.graph, (uint32_t)pairs[i % QUERIES].first, 16);
+        sink = field.hopsTo(0);
+    });
+}
+
+// ============ HIT-TESTING ============
+
+// DungeonGame::handleRoomClick: nearest room within CLICK_RADIUS that is
+// connected to the current room
+void benchClicks(int size) {
+    DungeonGraph dungeon;
+    makeDungeon(dungeon, size);
+    
+    Rng rng(opt.seed, 2);
+    const int CLICKS = 4096;
+    vector<pair<int, int>> clicks(CLICKS); // current room, then target room
+    vector<pair<int, int>> points(CLICKS);
+    for (int i = 0; i < CLICKS; i++) {
+        const auto& e = dungeon.builder.edges[rng.below((uint32_t)dungeon.builder.edges.size())];
+        clicks[i] = {(int)e.first, (int)e.second};
+        auto p = dungeon.positions[e.second];
+        points[i] = {p.first + (int)rng.below(2 * CLICK_RADIUS) - CLICK_RADIUS, p.second};
+    }
+    
+    measure("click.hit_test", size, [&](uint64_t ops) {
+        uint64_t found = 0;
+        for (uint64_t i = 0; i < ops; i++) {
+            const auto& pt = points[i % CLICKS];
+            found += dungeon.roomAt(pt.first, pt.second, clicks[i % CLICKS].first) >= 0;
+        }
+        sink = found;
+    });
+    
+    // Two rooms at opposite ends of the int range: the grid must stay
+    // sized by the room count, not by the area between them
+    DungeonGraph spread;
+    spread.addRoom(0, "West", -2000000000, -2000000000);
+    spread.addRoom(1, "East", 2000000000, 2000000000);
+    spread.connectRooms(0, 1);
+    spread.freeze();
+    if (spread.roomAt(2000000000 - 5, 2000000000, 0) != 1 || spread.roomAt(-2000000000, -2000000000 + 5, 1) != 0) {
+        fprintf(stderr, "click.hit_test_spread: far rooms not found\n");
+        exit(1);
+    }
+    measure("click.hit_test_spread", size, [&](uint64_t ops) {
+        uint64_t found = 0;
+        for (uint64_t i = 0; i < ops; i++) {
+            found += spread.roomAt(i & 1 ? 2000000000 : -2000000000, 2000000000 - (int)(i & 7), 0) >= 0;
+        }
+        sink = found;
+    });
+}
+
+// ============ LOGS ============
+
+// BattleLog (main.cpp) keeps QStrings; std::string stands in here so the
+// benchmark needs no Qt. The ring buffer and read pattern are the same.
+void benchLogs(int size) {
+    vector<string> lines(256);
+    for (size_t i = 0; i < lines.size(); i++) lines[i] = "Enemy hits you for " + to_string(i) + " damage!";
+    
+    RingBuffer<string, 100> battleLog;
+    measure("log.add_message", size, [&](uint64_t ops) {
+        for (uint64_t i = 0; i < ops; i++) battleLog.push(lines[i & 255]);
+        sink = battleLog.totalPushed();
+    });
+    
+    // size messages arrive between UI refreshes; each refresh reads the
+    // new ones (BattleLog::since). One op = one refresh.
+    measure("log.read_recent", size, [&](uint64_t ops) {
+        RingBuffer<string, 100> log;
+        uint64_t seen = 0;
+        size_t chars = 0;
+        for (uint64_t i = 0; i < ops; i++) {
+            for (int k = 0; k < size; k++) log.push(lines[k & 255]);
+            for (const string& line : log.recent((size_t)min<uint64_t>(log.totalPushed() - seen, 100))) {
+                chars += line.size();
+            }
+            seen = log.totalPushed();
+        }
+        sink = chars;
+    });
+    
+    // DungeonGame::addEvent: event queue plus the on-screen ring. addEvent
+    // never pops; the next update() tick drains the queue, so here size
+    // events arrive per tick and one op = one addEvent.
+    struct GameEvent {
+        string message;
+        int timestamp;
+    };
+    measure("event.add", size, [&](uint64_t ops) {
+        queue<GameEvent> eventQueue;
+        RingBuffer<GameEvent, 10> eventLog;
+        int counter = 0;
+        uint64_t drained = 0;
+        for (uint64_t i = 0; i < ops; i++) {
+            const string& msg = lines[i & 255];
+            eventQueue.push({msg, counter++});
+            eventLog.push({msg, counter});
+            if (eventQueue.size() == (size_t)size) {
+                while (!eventQueue.empty()) {
+                    eventQueue.pop();
+                    drained++;
+                }
+            }
+        }
+        sink = drained + eventQueue.size();
+    });
+}
+
+// ============ SKILLS ============
+
+// A full tree of `size` slots with every other skill unlocked; one op
+// visits every unlocked skill (was getUnlockedSkills)
+void benchSkills(int size) {
+    int slots = min(size, (int)SkillTree::MAX_SLOTS);
+    string text;
+    for (int i = 0; i < slots; i++) text += to_string(i) + "|Skill " + to_string(i) + "|0|" + to_string(i % 50) + "|attack\n";
+    SkillTree tree;
+    tree.parse(text);
+    int budget = 0;
+    for (int i = 2; i < slots; i += 2) tree.unlock(i, budget);
+    
+    measure("skills.for_each_unlocked", size, [&](uint64_t ops) {
+        uint64_t power = 0;
+        for (uint64_t i = 0; i < ops; i++) {
+            tree.forEachUnlocked([&](uint32_t slot) { power += tree.node(slot).power; });
+        }
+        sink = power;
+    });
+    
+    measure("skills.unlocked_count", size, [&](uint64_t ops) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < ops; i++) total += tree.unlockedCount();
+        sink = total;
+    });
+}
+
+// ============ COMBAT ============
+
+// One op = one round of `size` simultaneous battles (see battle_sim.cpp)
+void benchCombat(int size) {
+    CombatantBatch heroes, enemies;
+    heroes.assign(size, heroStatsForLevel(5));
+    enemies.assign(size, enemyStatsForLevel(5));
+    vector<int> roll(size), active(size, 1);
+    Rng rng(opt.seed, 3);
+    for (int& r : roll) r = rng.below(PLAYER_ATTACK_SPREAD);
+    
+    measure("combat.resolve_round", size, [&](uint64_t ops) {
+        for (uint64_t i = 0; i < ops; i++) {
+            if (i % 8 == 0) enemies.hp = enemies.maxHp; // keep everyone alive
+            resolveAttacks(heroes.attack.data(), roll.data(), active.data(), enemies.defense.data(),
+                           enemies.hp.data(), enemies.size());
+            resolveAttacks(enemies.attack.data(), roll.data(), active.data(), heroes.defense.data(),
+                           heroes.hp.data(), heroes.size());
+            if (i % 8 == 7) heroes.hp = heroes.maxHp;
+        }
+        sink = heroes.hp[0] + enemies.hp[0];
+    });
+    
+    // One op = one area ability over a pool of `size` enemies
+    int power = heroStatsForLevel(5).attack * 2;
+    measure("combat.area_attack", size, [&](uint64_t ops) {
+        long long dealt = 0;
+        for (uint64_t i = 0; i < ops; i++) {
+            if (i % 4 == 0) enemies.hp = enemies.maxHp;
+            dealt += resolveAreaAttack(power, enemies.defense.data(), enemies.hp.data(), enemies.size());
+        }
+        sink = (uint64_t)dealt;
+    });
+    
+    // One op = one round of status effects over `size` units, every one
+    // of them poisoned and regenerating
+    StatusPool status;
+    status.assign(enemies.size());
+    measure("combat.status_tick", size, [&](uint64_t ops) {
+        long long moved = 0;
+        for (uint64_t i = 0; i < ops; i++) {
+            if (i % 64 == 0) {
+                status.applyAll(STATUS_POISON, MAX_STATUS_ROUNDS);
+                status.applyAll(STATUS_REGEN, MAX_STATUS_ROUNDS);
+                enemies.hp = enemies.maxHp;
+            }
+            StatusTick tick = tickStatus(status, enemies.hp.data(), enemies.maxHp.data(), enemies.size());
+            moved += tick.poisoned + tick.regenerated;
+        }
+        sink = (uint64_t)moved;
+    });
+}
+
+// ============ RENDERING ============
+
+#if !defined(BENCH_NO_RENDER)
+// The batched part of DungeonGame::renderDungeon, drawn into an offscreen
+// 1200x800 texture. One op = one frame, including the per-frame color pass.
+void benchRender(int size) {
+    const float ROOM_RADIUS = 25;
+    const float ROOM_OUTLINE = 2;
+    const int ROOM_VERTICES = 16;
+    
+    sf::RenderTexture target;
+    CircleAtlas circles;
+    if (!target.create(1200, 800) || !circles.create(ROOM_RADIUS / (ROOM_RADIUS + ROOM_OUTLINE))) {
+        skipped("render.dungeon_frame", size, "no offscreen render target");
+        return;
+    }
+    DungeonGraph dungeon;
+    makeDungeon(dungeon, size);
+    
+    sf::VertexArray edgeBatch(sf::Lines);
+    sf::VertexArray roomBatch(sf::Quads);
+    for (int id = 0; id < dungeon.roomCount(); id++) {
+        auto p1 = dungeon.positions[id];
+        for (uint32_t other : dungeon.connections(id)) {
+            if ((int)other < id) continue;
+            auto p2 = dungeon.positions[other];
+            edgeBatch.append(sf::Vertex(sf::Vector2f(p1.first, p1.second), sf::Color(100, 100, 100)));
+            edgeBatch.append(sf::Vertex(sf::Vector2f(p2.first, p2.second), sf::Color(100, 100, 100)));
+        }
+        sf::Vector2f center(p1.first, p1.second);
+        circles.addRing(roomBatch, center, ROOM_RADIUS + ROOM_OUTLINE, sf::Color::White);
+        circles.addDisc(roomBatch, center, ROOM_RADIUS, sf::Color(100, 100, 100));
+        circles.addDisc(roomBatch, center + sf::Vector2f(0, -32), 8, sf::Color::Transparent);
+        circles.addDisc(roomBatch, center + sf::Vector2f(28, -32), 8, sf::Color::Transparent);
+    }
+    
+    measure("render.dungeon_frame", size, [&](uint64_t ops) {
+        for (uint64_t i = 0; i < ops; i++) {
+            int current = (int)(i % dungeon.roomCount());
+            for (int id = 0; id < dungeon.roomCount(); id++) {
+                size_t v = (size_t)id * ROOM_VERTICES;
+                sf::Color fill = id == current ? sf::Color::Green : sf::Color(100, 100, 100);
+                sf::Color monster = dungeon.hasMonster[id] ? sf::Color::Red : sf::Color::Transparent;
+                if (roomBatch[v + 4].color != fill) CircleAtlas::setColor(roomBatch, v + 4, fill);
+                if (roomBatch[v + 8].color != monster) CircleAtlas::setColor(roomBatch, v + 8, monster);
+            }
+            target.clear(sf::Color(20, 20, 30));
+            target.draw(edgeBatch);
+            target.draw(roomBatch, sf::RenderStates(&circles.texture()));
+            target.display();
+        }
+        sink = roomBatch.getVertexCount();
+    });
+}
+#endif
+
+// ============ COMMAND LINE ============
+
+void printUsage() {
+    cout << "Usage: benchmarks [--sizes N,N,...] [--filter TEXT] [--min-time SECONDS]\n"
+         << "                  [--repeats R] [--seed S]\n"
+         << "Prints one JSON object per benchmark and size.\n";
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sizes" && hasValue) {
+            opt.sizes.clear();
+            for (char* p = argv[++i]; *p;) {
+                opt.sizes.push_back(max(1, (int)strtol(p, &p, 10)));
+                if (*p == ',') p++;
+                else if (*p) break;
+            }
+        } else if (arg == "--filter" && hasValue) {
+            opt.filter = argv[++i];
+        } else if (arg == "--min-time" && hasValue) {
+            opt.minSeconds = atof(argv[++i]);
+        } else if (arg == "--repeats" && hasValue) {
+            opt.repeats = max(1, atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            opt.seed = strtoull(argv[++i], nullptr, 10);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    
+    for (int size : opt.sizes) {
+        benchGraph(size);
+        benchClicks(size);
+        benchLogs(size);
+        benchSkills(size);
+        benchCombat(size);
+#if !defined(BENCH_NO_RENDER)
+        benchRender(size);
+#endif
+    }
+    return 0;
+}
+
+// Compile with: g++ -O3 -std=c++17 -pthread benchmarks.cpp -o benchmarks -lsfml-graphics -lsfml-window -lsfml-system
+// Headless (no SFML): g++ -O3 -std=c++17 -pthread -DBENCH_NO_RENDER benchmarks.cpp -o benchmarks
@@ -0,0 +1,357 @@
+// combat.h
+// Combat rules shared by the Qt game (main.cpp) and the headless
+// battle simulator (battle_sim.cpp). No Qt types in here.
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#include "skill_tree.h"
+
+// ============ COMBAT RULES ============
+
+const int PLAYER_ATTACK_SPREAD = 15; // player hits for attack + [0, 15)
+const int ENEMY_ATTACK_SPREAD = 10;  // enemies hit for attack + [0, 10)
+const int POTION_HEAL = 40;
+
+struct CombatStats {
+    int hp;
+    int mp;
+    int attack;
+    int defense;
+    int speed; // see BattleScheduler
+};
+
+// Stats grow linearly from `start` at level `from`; speed only gains its
+// perLevel every speedEvery levels
+struct StatCurve {
+    CombatStats start;
+    CombatStats perLevel;
+    int from;
+    int speedEvery;
+};
+
+// Enemy stats scale with the location's enemy level
+constexpr StatCurve ENEMY_CURVE = {{40, 20, 10, 5, 9}, {15, 5, 5, 2, 1}, 0, 2};
+
+// The hero starts at 100/50/20/10/10 and every level up adds 20/10/5/3/1
+constexpr StatCurve HERO_CURVE = {{100, 50, 20, 10, 10}, {20, 10, 5, 3, 1}, 1, 1};
+
+constexpr CombatStats statsAt(const StatCurve& curve, int level) {
+    int ups = level - curve.from;
+    return {curve.start.hp + ups * curve.perLevel.hp,
+            curve.start.mp + ups * curve.perLevel.mp,
+            curve.start.attack + ups * curve.perLevel.attack,
+            curve.start.defense + ups * curve.perLevel.defense,
+            curve.start.speed + ups / curve.speedEvery * curve.perLevel.speed};
+}
+
+constexpr CombatStats enemyStatsForLevel(int level) { return statsAt(ENEMY_CURVE, level); }
+constexpr CombatStats heroStatsForLevel(int level) { return statsAt(HERO_CURVE, level); }
+
+// Each unit of a group gets an even share of one enemy's HP and attack,
+// so a group is as tough as the single enemy it replaces, only spread out
+constexpr CombatStats enemyGroupStatsForLevel(int level, int groupSize) {
+    CombatStats stats = enemyStatsForLevel(level);
+    stats.hp = std::max(1, (stats.hp + groupSize - 1) / groupSize);
+    stats.attack = std::max(1, stats.attack / groupSize);
+    return stats;
+}
+
+static_assert(enemyStatsForLevel(3).hp == 85 && enemyStatsForLevel(3).speed == 10, "enemy curve");
+static_assert(heroStatsForLevel(4).attack == 35 && heroStatsForLevel(4).speed == 13, "hero curve");
+
+// Defense soaks damage, but every hit does at least 1
+constexpr int mitigatedDamage(int damage, int defense) {
+    return std::max(1, damage - defense);
+}
+
+constexpr int expReward(int enemyLevel) { return enemyLevel * 30; }
+
+// ============ STRUCTURE-OF-ARRAYS BATCH ============
+
+const size_t MAX_ENEMY_GROUP = 1000; // units in one encounter
+
+// One array per stat so damage resolution is a straight loop over ints.
+// Also the pool for one side of a battle: unit u is index u everywhere.
+// clear() and assign() keep the capacity, so once a pool has been
+// reserved for the largest group, encounters recycle it without allocating.
+struct CombatantBatch {
+    std::vector<int> hp;
+    std::vector<int> maxHp;
+    std::vector<int> attack;
+    std::vector<int> defense;
+    std::vector<int> speed;
+    
+    size_t size() const { return hp.size(); }
+    
+    void assign(size_t count, const CombatStats& s) {
+        hp.assign(count, s.hp);
+        maxHp.assign(count, s.hp);
+        attack.assign(count, s.attack);
+        defense.assign(count, s.defense);
+        speed.assign(count, s.speed);
+    }
+    
+    void clear() { assign(0, CombatStats()); }
+    
+    void reserve(size_t count) {
+        hp.reserve(count);
+        maxHp.reserve(count);
+        attack.reserve(count);
+        defense.reserve(count);
+        speed.reserve(count);
+    }
+    
+    // First unit at or after from that is still standing, size() if none
+    size_t firstStanding(size_t from = 0) const {
+        while (from < hp.size() && hp[from] <= 0) from++;
+        return from;
+    }
+    
+    size_t standing() const {
+        size_t n = 0;
+        for (int h : hp) n += h > 0;
+        return n;
+    }
+};
+
+// attacker[i] hits defender[i] for attack + roll[i] wherever active[i] is
+// set. Branch-free so the compiler can vectorize it.
+inline void resolveAttacks(const int* attack, const int* roll, const int* active,
+                           const int* defense, int* hp, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        int dmg = std::max(1, attack[i] + roll[i] - defense[i]);
+        int left = std::max(0, hp[i] - dmg);
+        hp[i] = active[i] ? left : hp[i];
+    }
+}
+
+// Area attack: every unit takes power through its own defense, at least
+// 1 as in mitigatedDamage; the fallen stay at 0. One branch-free pass
+// over the pool. Returns the HP actually taken off.
+inline long long resolveAreaAttack(int power, const int* defense, int* hp, size_t count) {
+    long long dealt = 0;
+    for (size_t i = 0; i < count; i++) {
+        int dmg = std::max(1, power - defense[i]);
+        int left = std::max(0, hp[i] - dmg);
+        dealt += hp[i] - left;
+        hp[i] = left;
+    }
+    return dealt;
+}
+
+// ============ STATUS EFFECTS ============
+
+enum StatusEffect : uint8_t { STATUS_POISON, STATUS_REGEN, STATUS_HASTE, STATUS_SHIELD, STATUS_COUNT };
+
+const int STATUS_HP_DIVISOR = 12;   // poison and regen move maxHp / 12 a round, at least 1
+const int SHIELD_DEFENSE = 10;      // like Defend, but for whole rounds
+const int HASTE_SPEED_PERCENT = 150;
+const int MAX_STATUS_ROUNDS = 255;
+
+constexpr const char* statusName(StatusEffect effect) {
+    switch (effect) {
+        case STATUS_POISON: return "Poison";
+        case STATUS_REGEN: return "Regen";
+        case STATUS_HASTE: return "Haste";
+        case STATUS_SHIELD: return "Shield";
+        case STATUS_COUNT: break;
+    }
+    return "?";
+}
+
+constexpr bool hasStatus(uint8_t active, StatusEffect effect) { return (active >> effect) & 1; }
+
+constexpr int statusSpeed(int speed, uint8_t active) {
+    return hasStatus(active, STATUS_HASTE) ? speed * HASTE_SPEED_PERCENT / 100 : speed;
+}
+
+constexpr int statusDefense(uint8_t active) {
+    return hasStatus(active, STATUS_SHIELD) ? SHIELD_DEFENSE : 0;
+}
+
+// Effects for one side of a battle, next to its CombatantBatch: unit u is
+// index u. What is up is one bitset byte per unit; each effect keeps its
+// own byte array of rounds left. Ticking a side is then a fixed number of
+// straight passes, however many effects are up on however many units.
+struct StatusPool {
+    std::vector<uint8_t> active; // bit e set = effect e is up
+    std::vector<uint8_t> roundsLeft[STATUS_COUNT];
+    
+    size_t size() const { return active.size(); }
+    
+    // Everyone starts clean
+    void assign(size_t count) {
+        active.assign(count, 0);
+        for (auto& rounds : roundsLeft) rounds.assign(count, 0);
+    }
+    
+    void clear() { assign(0); }
+    
+    void reserve(size_t count) {
+        active.reserve(count);
+        for (auto& rounds : roundsLeft) rounds.reserve(count);
+    }
+    
+    bool has(size_t unit, StatusEffect effect) const { return hasStatus(active[unit], effect); }
+    
+    // Starts an effect, or extends it if the new one lasts longer
+    void apply(size_t unit, StatusEffect effect, int rounds) {
+        rounds = std::min(rounds, MAX_STATUS_ROUNDS);
+        if (rounds <= 0) return;
+        roundsLeft[effect][unit] = std::max(roundsLeft[effect][unit], (uint8_t)rounds);
+        active[unit] |= 1 << effect;
+    }
+    
+    void applyAll(StatusEffect effect, int rounds) {
+        for (size_t u = 0; u < size(); u++) apply(u, effect, rounds);
+    }
+};
+
+struct StatusTick {
+    long long poisoned = 0;    // HP taken by poison
+    long long regenerated = 0; // HP given back by regen
+    uint8_t expired = 0;       // effects that ran out on any unit
+};
+
+// One round of effects for a whole side. Poison bites first, then regen
+// heals what is still standing; the fallen stay at 0. Then every duration
+// counts down and an effect's bit drops when its count reaches zero.
+// Branch-free per unit, one pass for HP and one per effect.
+inline StatusTick tickStatus(StatusPool& status, int* hp, const int* maxHp, size_t count) {
+    StatusTick tick;
+    uint8_t* active = status.active.data();
+    for (size_t i = 0; i < count; i++) {
+        int amount = std::max(1, maxHp[i] / STATUS_HP_DIVISOR);
+        int poison = (active[i] >> STATUS_POISON) & 1;
+        int regen = (active[i] >> STATUS_REGEN) & 1;
+        int dmg = poison * std::min(amount, hp[i]);
+        int left = hp[i] - dmg;
+        int heal = regen * (left > 0) * std::min(amount, maxHp[i] - left);
+        hp[i] = left + heal;
+        tick.poisoned += dmg;
+        tick.regenerated += heal;
+    }
+    for (int e = 0; e < STATUS_COUNT; e++) {
+        uint8_t* rounds = status.roundsLeft[e].data();
+        uint8_t done = 0;
+        for (size_t i = 0; i < count; i++) {
+            int running = rounds[i] > 0;
+            rounds[i] -= running;
+            int ended = running & (rounds[i] == 0);
+            active[i] &= ~(ended << e);
+            done |= ended;
+        }
+        tick.expired |= done << e;
+    }
+    return tick;
+}
+
+// ============ ABILITIES ============
+
+enum SkillTarget : uint8_t { TARGET_NONE, TARGET_SELF, TARGET_FRONT, TARGET_ALL_ENEMIES };
+
+// What an ability kind does with its power: deal it as damage, heal it,
+// or apply `status` for that many rounds (STATUS_COUNT = no status)
+struct SkillRule {
+    SkillTarget target;
+    bool damage;
+    bool heal;
+    StatusEffect status;
+};
+
+// Indexed by SkillKind. Constant, so a caster can pick its code for each
+// kind at compile time (see FantasyRPG::cast)
+constexpr SkillRule SKILL_RULES[SKILL_KIND_COUNT] = {
+    {TARGET_NONE, false, false, STATUS_COUNT},         // passive
+    {TARGET_FRONT, true, false, STATUS_COUNT},         // attack
+    {TARGET_SELF, false, true, STATUS_COUNT},          // heal
+    {TARGET_ALL_ENEMIES, true, false, STATUS_COUNT},   // area
+    {TARGET_SELF, false, false, STATUS_REGEN},         // regen
+    {TARGET_SELF, false, false, STATUS_HASTE},         // haste
+    {TARGET_SELF, false, false, STATUS_SHIELD},        // shield
+    {TARGET_ALL_ENEMIES, false, false, STATUS_POISON}, // poison
+};
+
+// ============ TURN SCHEDULER ============
+
+const uint64_t TURN_TIME = 15000; // virtual ms per action times speed: speed 10 acts every 1.5 s
+
+enum BattleSide { SIDE_HERO, SIDE_ENEMY };
+
+struct BattleTurn {
+    uint64_t at; // virtual ms since the battle started
+    int speed;
+    uint32_t order; // when it was scheduled, for ties
+    BattleSide side;
+    uint32_t unit;  // index in that side's CombatantBatch
+    
+    // The heap pops the largest, so "less" means "later": earlier time
+    // first, then higher speed, then first scheduled
+    bool operator<(const BattleTurn& other) const {
+        if (at != other.at) return at > other.at;
+        if (speed != other.speed) return speed < other.speed;
+        return order > other.order;
+    }
+};
+
+// Turn order in virtual time, one entry per unit. Acting costs
+// TURN_TIME / speed, so a unit twice as fast gets two turns for every one
+// of the other's. The clock only moves when a turn is taken: headless
+// code takes them back to back, the GUI waits untilNext() real ms before
+// an enemy turn to pace the fight. Same speeds, same order either way.
+//
+// Units of a group share a speed, so their turns fall on the same instant
+// and can be resolved together. A fallen unit's entry is simply dropped
+// when it comes up.
+//
+// The queue is a binary heap in a vector that clear() empties but keeps,
+// so back-to-back battles reuse the same storage.
+class BattleScheduler {
+public:
+    // Every unit starts from zero, so the fastest moves first
+    void start(const CombatantBatch& heroes, const CombatantBatch& enemies) {
+        clear();
+        reserve(heroes.size() + enemies.size());
+        for (uint32_t u = 0; u < heroes.size(); u++) schedule(SIDE_HERO, heroes.speed[u], u);
+        for (uint32_t u = 0; u < enemies.size(); u++) schedule(SIDE_ENEMY, enemies.speed[u], u);
+    }
+    
+    void clear() {
+        turns.clear();
+        clock = 0;
+        issued = 0;
+    }
+    
+    // Room for this many units without growing mid-battle
+    void reserve(size_t units) { turns.reserve(units); }
+    
+    // Queues a unit's next turn one action from now
+    void schedule(BattleSide side, int speed, uint32_t unit = 0) {
+        speed = std::max(1, speed);
+        turns.push_back({clock + TURN_TIME / (uint64_t)speed, speed, issued++, side, unit});
+        std::push_heap(turns.begin(), turns.end());
+    }
+    
+    bool empty() const { return turns.empty(); }
+    const BattleTurn& peek() const { return turns.front(); }
+    uint64_t now() const { return clock; }
+    uint64_t untilNext() const { return turns.front().at - clock; }
+    
+    // Removes the next turn and moves the clock to it
+    BattleTurn next() {
+        std::pop_heap(turns.begin(), turns.end());
+        BattleTurn t = turns.back();
+        turns.pop_back();
+        clock = t.at;
+        return t;
+    }
+    
+private:
+    std::vector<BattleTurn> turns; // max-heap on operator<
+    uint64_t clock = 0;
+    uint32_t issued = 0;
+};
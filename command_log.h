@@ -0,0 +1,198 @@
+// command_log.h
+// Compact binary log of player commands, for deterministic replay of a
+// session (both games draw every random number from a seeded RngService)
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// ============ FILE LAYOUT ============
+//
+//   CommandLogHeader
+//   game name, world name (gameLength and worldLength bytes, no NUL)
+//   records: type byte, then the argument as a LEB128 varint
+//
+// A travel to room 5000 is three bytes; everything else is one or two.
+// The world name is a path, or "generate:N" for a procedural dungeon.
+
+const char COMMAND_LOG_MAGIC[4] = {'C', 'S', 'C', 'L'};
+const uint32_t COMMAND_LOG_VERSION = 3; // 2: enemy turns from the battle scheduler, 3: status effects
+
+// Only the player's commands are logged; routes, searches and saves are
+// not. Enemy turns follow from them (see BattleScheduler in combat.h).
+enum CommandType : uint8_t {
+    CMD_TRAVEL = 1,     // arg: room / location id
+    CMD_BACKTRACK,
+    CMD_ATTACK,
+    CMD_DEFEND,
+    CMD_USE_ITEM,
+    CMD_ABILITY,        // arg: ability slot
+    CMD_UNLOCK,         // arg: skill slot
+    CMD_LOAD,           // state came from a save file; replay stops here
+    CMD_LAST = CMD_LOAD
+};
+
+struct Command {
+    CommandType type;
+    uint32_t arg;
+};
+
+struct CommandLogHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t seed;
+    uint32_t gameLength;
+    uint32_t worldLength;
+};
+
+inline const char* commandName(CommandType type) {
+    switch (type) {
+        case CMD_TRAVEL: return "travel";
+        case CMD_BACKTRACK: return "backtrack";
+        case CMD_ATTACK: return "attack";
+        case CMD_DEFEND: return "defend";
+        case CMD_USE_ITEM: return "use item";
+        case CMD_ABILITY: return "ability";
+        case CMD_UNLOCK: return "unlock";
+        case CMD_LOAD: return "load";
+    }
+    return "?";
+}
+
+// ============ RECORDER ============
+
+// Each record is flushed as it is written, so the log survives a crash
+// up to the last command. record() does nothing while no file is open.
+class CommandRecorder {
+public:
+    ~CommandRecorder() { close(); }
+    
+    bool open(const std::string& path, const std::string& game, uint64_t seed,
+              const std::string& world) {
+        close();
+        file = fopen(path.c_str(), "wb");
+        if (!file) return false;
+        CommandLogHeader header;
+        memcpy(header.magic, COMMAND_LOG_MAGIC, 4);
+        header.version = COMMAND_LOG_VERSION;
+        header.seed = seed;
+        header.gameLength = (uint32_t)game.size();
+        header.worldLength = (uint32_t)world.size();
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+            && fwrite(game.data(), 1, game.size(), file) == game.size()
+            && fwrite(world.data(), 1, world.size(), file) == world.size()
+            && fflush(file) == 0;
+        if (!ok) close();
+        return ok;
+    }
+    
+    bool isOpen() const { return file != nullptr; }
+    uint64_t recorded() const { return count; }
+    
+    void record(CommandType type, uint32_t arg = 0) {
+        if (!file) return;
+        uint8_t bytes[6];
+        size_t n = 0;
+        bytes[n++] = type;
+        do {
+            uint8_t b = arg & 0x7F;
+            arg >>= 7;
+            bytes[n++] = arg ? (uint8_t)(b | 0x80) : b;
+        } while (arg);
+        fwrite(bytes, 1, n, file);
+        fflush(file);
+        count++;
+    }
+    
+    void close() {
+        if (file) fclose(file);
+        file = nullptr;
+    }
+    
+private:
+    FILE* file = nullptr;
+    uint64_t count = 0;
+};
+
+// ============ READER ============
+
+struct CommandLog {
+    std::string game;
+    std::string world;
+    uint64_t seed = 0;
+    std::vector<Command> commands;
+};
+
+// A record cut short at the end of the file (the game died mid-write) is
+// dropped; anything else malformed fails with error set.
+inline bool readCommandLog(const std::string& path, CommandLog& log, std::string& error) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[1 << 16];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + got);
+    fclose(f);
+    
+    CommandLogHeader header;
+    if (data.size() < sizeof(header)) {
+        error = "not a command log";
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (memcmp(header.magic, COMMAND_LOG_MAGIC, 4) != 0) {
+        error = "not a command log";
+        return false;
+    }
+    if (header.version != COMMAND_LOG_VERSION) {
+        error = "unsupported command log version " + std::to_string(header.version);
+        return false;
+    }
+    size_t pos = sizeof(header);
+    if ((uint64_t)header.gameLength + header.worldLength > data.size() - pos) {
+        error = "truncated header";
+        return false;
+    }
+    log.seed = header.seed;
+    log.game.assign((const char*)&data[pos], header.gameLength);
+    pos += header.gameLength;
+    log.world.assign((const char*)&data[pos], header.worldLength);
+    pos += header.worldLength;
+    
+    log.commands.clear();
+    log.commands.reserve(data.size() - pos);
+    while (pos < data.size()) {
+        uint8_t type = data[pos++];
+        if (type == 0 || type > CMD_LAST) {
+            error = "bad command type " + std::to_string(type) + " at byte " + std::to_string(pos - 1);
+            return false;
+        }
+        uint32_t arg = 0;
+        int shift = 0;
+        bool complete = false;
+        while (pos < data.size() && shift < 35) {
+            uint8_t b = data[pos++];
+            arg |= (uint32_t)(b & 0x7F) << shift;
+            shift += 7;
+            if (!(b & 0x80)) {
+                complete = true;
+                break;
+            }
+        }
+        if (!complete) {
+            if (pos < data.size()) {
+                error = "bad argument at byte " + std::to_string(pos);
+                return false;
+            }
+            break;
+        }
+        log.commands.push_back({(CommandType)type, arg});
+    }
+    return true;
+}
@@ -0,0 +1,174 @@
+// distance_field.h
+// Multi-source BFS hop distances over a CsrGraph: danger maps, fog of
+// war and "nearest X" queries in one pass over the graph
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#include "graph_core.h"
+
+// ============ DISTANCE FIELD ============
+
+// hopsTo(u) is the number of edges from u to the nearest source and
+// nearestSource(u) is that source. Buffers are kept between computes and
+// only the visited bitset is cleared, so a field bounded by maxHops costs
+// n/64 words plus the part of the graph it actually reaches.
+//
+// Direction-optimizing BFS (Beamer et al.): while the frontier is small,
+// expand it top-down from a queue; once its edges outnumber the edges
+// still unexplored, switch to bottom-up, where every unvisited node scans
+// its neighbors for one in the frontier bitset and stops at the first hit.
+// Big open levels then cost about one check per unvisited node.
+class DistanceField {
+public:
+    static constexpr uint32_t UNREACHED = 0xFFFFFFFFu;
+    
+    bool reached(uint32_t u) const { return test(visited, u); }
+    uint32_t hopsTo(uint32_t u) const { return reached(u) ? hops[u] : UNREACHED; }
+    uint32_t nearestSource(uint32_t u) const { return reached(u) ? origin[u] : UNREACHED; }
+    
+    // Calls fn(node, hops) for every reached node in id order
+    template <class Fn>
+    void forEachReached(Fn fn) const {
+        forEachBit(visited, [&](uint32_t u) { fn(u, hops[u]); });
+    }
+    
+    // Nodes further than maxHops from every source stay UNREACHED
+    void compute(const CsrGraph& g, const uint32_t* sources, size_t sourceCount,
+                 uint32_t maxHops = UNREACHED) {
+        uint32_t n = g.nodeCount();
+        size_t words = ((size_t)n + 63) / 64;
+        hops.resize(n);
+        origin.resize(n);
+        visited.assign(words, 0);
+        frontierBits.assign(words, 0);
+        nextBits.assign(words, 0);
+        queue.clear();
+        
+        uint64_t unexploredArcs = g.arcCount();
+        for (size_t i = 0; i < sourceCount; i++) {
+            uint32_t s = sources[i];
+            if (s >= n || test(visited, s)) continue;
+            set(visited, s);
+            hops[s] = 0;
+            origin[s] = s;
+            queue.push_back(s);
+            unexploredArcs -= g.degree(s);
+        }
+        
+        uint64_t frontierArcs = 0;
+        for (uint32_t u : queue) frontierArcs += g.degree(u);
+        size_t frontierSize = queue.size();
+        bool bottomUp = false;
+        
+        for (uint32_t depth = 1; frontierSize > 0 && depth <= maxHops; depth++) {
+            // Switch when the frontier touches more arcs than are left to
+            // explore; switch back once it shrinks to a sliver of the graph
+            if (!bottomUp && frontierArcs > unexploredArcs / ALPHA) {
+                bottomUp = true;
+                std::fill(frontierBits.begin(), frontierBits.end(), 0);
+                for (uint32_t u : queue) set(frontierBits, u);
+            } else if (bottomUp && frontierSize < n / BETA) {
+                bottomUp = false;
+                queue.clear();
+                forEachBit(frontierBits, [&](uint32_t u) { queue.push_back(u); });
+            }
+            
+            frontierArcs = 0;
+            if (bottomUp) {
+                frontierSize = stepBottomUp(g, depth, frontierArcs);
+                frontierBits.swap(nextBits);
+            } else {
+                frontierSize = stepTopDown(g, depth, frontierArcs);
+                queue.swap(nextQueue);
+            }
+            unexploredArcs -= frontierArcs;
+        }
+    }
+    
+    void compute(const CsrGraph& g, const std::vector<uint32_t>& sources,
+                 uint32_t maxHops = UNREACHED) {
+        compute(g, sources.data(), sources.size(), maxHops);
+    }
+    
+    void compute(const CsrGraph& g, uint32_t source, uint32_t maxHops = UNREACHED) {
+        compute(g, &source, 1, maxHops);
+    }
+    
+private:
+    static constexpr uint64_t ALPHA = 14; // from the paper
+    static constexpr uint32_t BETA = 24;
+    
+    std::vector<uint32_t> hops;   // valid where visited is set
+    std::vector<uint32_t> origin;
+    std::vector<uint64_t> visited;
+    std::vector<uint64_t> frontierBits;
+    std::vector<uint64_t> nextBits;
+    std::vector<uint32_t> queue;
+    std::vector<uint32_t> nextQueue;
+    
+    static bool test(const std::vector<uint64_t>& bits, uint32_t u) { return (bits[u >> 6] >> (u & 63)) & 1; }
+    static void set(std::vector<uint64_t>& bits, uint32_t u) { bits[u >> 6] |= 1ull << (u & 63); }
+    
+    template <class Fn>
+    static void forEachBit(const std::vector<uint64_t>& bits, Fn fn) {
+        for (size_t w = 0; w < bits.size(); w++) {
+            for (uint64_t word = bits[w]; word; word &= word - 1) {
+                fn((uint32_t)(w * 64 + lowestBit(word)));
+            }
+        }
+    }
+    
+    size_t stepTopDown(const CsrGraph& g, uint32_t depth, uint64_t& nextArcs) {
+        nextQueue.clear();
+        for (uint32_t u : queue) {
+            for (uint32_t v : g.neighborsOf(u)) {
+                if (test(visited, v)) continue;
+                set(visited, v);
+                hops[v] = depth;
+                origin[v] = origin[u];
+                nextQueue.push_back(v);
+                nextArcs += g.degree(v);
+            }
+        }
+        return nextQueue.size();
+    }
+    
+    // Walks the unvisited nodes a word of the visited bitset at a time
+    size_t stepBottomUp(const CsrGraph& g, uint32_t depth, uint64_t& nextArcs) {
+        std::fill(nextBits.begin(), nextBits.end(), 0);
+        uint32_t n = g.nodeCount();
+        size_t found = 0;
+        for (size_t w = 0; w < visited.size(); w++) {
+            uint64_t open = ~visited[w];
+            if (w == visited.size() - 1 && n % 64) open &= (1ull << (n % 64)) - 1;
+            for (; open; open &= open - 1) {
+                uint32_t v = (uint32_t)(w * 64 + lowestBit(open));
+                for (uint32_t u : g.neighborsOf(v)) {
+                    if (!test(frontierBits, u)) continue;
+                    hops[v] = depth;
+                    origin[v] = origin[u];
+                    set(nextBits, v);
+                    nextArcs += g.degree(v);
+                    found++;
+                    break;
+                }
+            }
+            visited[w] |= nextBits[w];
+        }
+        return found;
+    }
+    
+    static int lowestBit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(word);
+#else
+        int b = 0;
+        while (!(word & 1)) { word >>= 1; b++; }
+        return b;
+#endif
+    }
+};
@@ -0,0 +1,198 @@
+// dungeon.h
+// Dungeon room graph and the seeded procedural generator behind --generate
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "graph_core.h"
+#include "routing.h"
+#include "rng.h"
+#include "spatial_grid.h"
+
+// ============ DUNGEON GRAPH ============
+
+// Room ids are dense indices; per-room attributes live in parallel arrays
+const int CLICK_RADIUS = 30; // pixels from a room's center that count as a hit
+const int GRID_CELL = 64;    // spatial grid cell, at least CLICK_RADIUS
+
+class DungeonGraph {
+public:
+    std::vector<std::string> names;
+    std::vector<std::pair<int, int>> positions; // visual positions
+    std::vector<uint8_t> hasMonster;
+    std::vector<uint8_t> hasTreasure;
+    std::vector<uint8_t> visited;
+    
+    GraphBuilder builder; // LIST of edges while building
+    CsrGraph graph;       // frozen adjacency for traversal
+    EdgeSet edges;        // HASHSET for O(1) adjacency checks
+    SpatialGrid grid;     // rooms bucketed by screen position
+    
+    void addRoom(int id, std::string name, int x, int y) {
+        if (id >= roomCount()) resize(id + 1);
+        names[id] = name;
+        positions[id] = {x, y};
+    }
+    
+    // Grows every per-room array together; new rooms are empty
+    void resize(int rooms) {
+        names.resize(rooms);
+        positions.resize(rooms);
+        hasMonster.resize(rooms, false);
+        hasTreasure.resize(rooms, false);
+        visited.resize(rooms, false);
+    }
+    
+    // Edge weight defaults to the on-screen distance, so A* can use
+    // positions; a given length must not be shorter than that
+    void connectRooms(int r1, int r2, float length = -1) {
+        if (length < 0) length = straightLine(positions[r1], positions[r2]);
+        builder.addEdge(r1, r2, length);
+    }
+    
+    void reserve(size_t rooms, size_t corridors) {
+        names.reserve(rooms);
+        positions.reserve(rooms);
+        hasMonster.reserve(rooms);
+        hasTreasure.reserve(rooms);
+        visited.reserve(rooms);
+        builder.reserve(corridors);
+    }
+    
+    // Build the CSR adjacency; call after the last connectRooms
+    void freeze() {
+        graph = builder.freeze(roomCount());
+        edges.build(graph);
+        grid.build(positions, GRID_CELL);
+    }
+    
+    int roomCount() const { return (int)names.size(); }
+    CsrGraph::Range connections(int id) const { return graph.neighborsOf(id); }
+    bool areConnected(int a, int b) const { return edges.contains(a, b); }
+    
+    // Closest room within CLICK_RADIUS of (x, y) that has a corridor to
+    // from, or -1
+    int roomAt(int x, int y, int from) const {
+        int target = -1;
+        long long bestDist = 0;
+        grid.forEachNear(positions, x, y, CLICK_RADIUS, [&](uint32_t id, long long d2) {
+            if ((target < 0 || d2 < bestDist) && areConnected(from, id)) {
+                target = id;
+                bestDist = d2;
+            }
+        });
+        return target;
+    }
+    
+    Route findPath(int from, int to) const { return aStar(graph, positions, from, to); }
+    
+    void setMonster(int id) { hasMonster[id] = true; }
+    void setTreasure(int id) { hasTreasure[id] = true; }
+};
+
+// ============ PROCEDURAL GENERATION ============
+const int MIN_GENERATED_ROOMS = 10;
+const int MAX_GENERATED_ROOMS = 10000000;
+const int GEN_SPACING = 80;      // pixels between grid cells
+const int GEN_JITTER = 15;       // max random offset from the cell center
+const uint32_t GEN_CHUNK = 4096; // rooms per work item
+
+// Rooms sit on a jittered square grid in id order. Every room but room 0
+// gets at least one corridor to a lower id (left or up), so the graph is
+// connected; extra left/up/diagonal corridors add loops.
+//
+// Work is split into fixed chunks of rooms and each chunk has its own
+// random stream, so the result depends only on seed and size, never on
+// the thread count. Two passes: rooms first, then corridors, since a
+// corridor's length needs the positions of rooms in other chunks.
+inline void generateDungeon(DungeonGraph& dungeon, std::vector<int>& monsterHealth, int rooms,
+                            uint64_t seed, unsigned threads) {
+    const int side = (int)std::ceil(std::sqrt((double)rooms));
+    const uint32_t chunks = ((uint32_t)rooms + GEN_CHUNK - 1) / GEN_CHUNK;
+    
+    dungeon = DungeonGraph();
+    dungeon.resize(rooms);
+    monsterHealth.assign(rooms, 0);
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> chunkEdges(chunks);
+    std::vector<std::vector<float>> chunkLengths(chunks);
+    
+    auto placeRooms = [&](uint32_t c) {
+        Rng rng(seed, c);
+        int last = std::min(rooms, (int)((c + 1) * GEN_CHUNK));
+        for (int id = c * GEN_CHUNK; id < last; id++) {
+            int x = 100 + (id % side) * GEN_SPACING + (int)rng.below(2 * GEN_JITTER + 1) - GEN_JITTER;
+            int y = 100 + (id / side) * GEN_SPACING + (int)rng.below(2 * GEN_JITTER + 1) - GEN_JITTER;
+            dungeon.names[id] = "Room " + std::to_string(id);
+            dungeon.positions[id] = {x, y};
+            if (id > 0 && rng.chance(12)) {
+                dungeon.hasMonster[id] = true;
+                monsterHealth[id] = 20 + rng.below(40);
+            }
+            if (id > 0 && rng.chance(8)) dungeon.hasTreasure[id] = true;
+        }
+    };
+    
+    auto digCorridors = [&](uint32_t c) {
+        Rng rng(seed, ((uint64_t)1 << 32) | c);
+        auto& edges = chunkEdges[c];
+        auto& lengths = chunkLengths[c];
+        auto dig = [&](int a, int b) {
+            edges.push_back({(uint32_t)a, (uint32_t)b});
+            lengths.push_back(straightLine(dungeon.positions[a], dungeon.positions[b]));
+        };
+        int last = std::min(rooms, (int)((c + 1) * GEN_CHUNK));
+        edges.reserve((last - c * GEN_CHUNK) * 2);
+        lengths.reserve(edges.capacity());
+        for (int id = c * GEN_CHUNK; id < last; id++) {
+            int col = id % side;
+            bool left = col > 0 && rng.chance(75);
+            bool up = id >= side && rng.chance(75);
+            if (!left && !up) {
+                if (col > 0) left = true;
+                else up = id >= side;
+            }
+            if (left) dig(id, id - 1);
+            if (up) dig(id, id - side);
+            if (col > 0 && id > side && rng.chance(10)) dig(id, id - side - 1);
+        }
+    };
+    
+    auto runPass = [&](const std::function<void(uint32_t)>& pass) {
+        std::atomic<uint32_t> nextChunk(0);
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; t++) {
+            pool.emplace_back([&] {
+                for (uint32_t c; (c = nextChunk.fetch_add(1)) < chunks;) pass(c);
+            });
+        }
+        for (auto& th : pool) th.join();
+    };
+    runPass(placeRooms);
+    runPass(digCorridors);
+    
+    // Chunk order, so adjacency lists come out the same on every run
+    size_t total = 0;
+    for (auto& e : chunkEdges) total += e.size();
+    dungeon.builder.reserve(total);
+    for (uint32_t c = 0; c < chunks; c++) {
+        auto& b = dungeon.builder;
+        b.edges.insert(b.edges.end(), chunkEdges[c].begin(), chunkEdges[c].end());
+        b.lengths.insert(b.lengths.end(), chunkLengths[c].begin(), chunkLengths[c].end());
+        std::vector<std::pair<uint32_t, uint32_t>>().swap(chunkEdges[c]);
+        std::vector<float>().swap(chunkLengths[c]);
+    }
+    
+    // The far corner holds the dragon and the winning treasure
+    int goal = rooms - 1;
+    dungeon.names[goal] = "Dragon Lair";
+    dungeon.hasMonster[goal] = true;
+    dungeon.hasTreasure[goal] = true;
+    monsterHealth[goal] = 80;
+}
@@ -6,78 +6,38 @@
 #include <unordered_map>
 #include <map>
 #include <cmath>
-#include <cstdlib>
-#include <ctime>
+
+#include "graph_core.h"
+#include "routing.h"
+#include "dungeon.h"
+#include "distance_field.h"
+#include "autocomplete.h"
+#include "rng.h"
+#include "ring_buffer.h"
+#include "render_batch.h"
+#include "spatial_grid.h"
+#include "skill_tree.h"
+#include "snapshot.h"
+#include "world_loader.h"
+#include "profiler.h"
+#include "command_log.h"
 
 using namespace std;
 
 // ============ DATA STRUCTURES ============
 
-// 1. GRAPH - Dungeon room connections
-struct Room {
-    int id;
-    string name;
-    bool hasMonster;
-    bool hasTreasure;
-    bool visited;
-    vector<int> connections; // LIST of connected rooms
-};
-
-class DungeonGraph {
-public:
-    unordered_map<int, Room> rooms; // HASHMAP of rooms
-    unordered_map<int, pair<int, int>> positions; // HASHMAP for visual positions
-    
-    void addRoom(int id, string name, int x, int y) {
-        rooms[id] = {id, name, false, false, false, {}};
-        positions[id] = {x, y};
-    }
-    
-    void connectRooms(int r1, int r2) {
-        rooms[r1].connections.push_back(r2);
-        rooms[r2].connections.push_back(r1);
-    }
-    
-    void setMonster(int id) { rooms[id].hasMonster = true; }
-    void setTreasure(int id) { rooms[id].hasTreasure = true; }
-};
+// 1. GRAPH - Dungeon room connections (DungeonGraph, see dungeon.h)
 
-// 2. TREE - Skill tree for player upgrades
-struct SkillNode {
-    string name;
-    int cost;
-    bool unlocked;
-    SkillNode* left;
-    SkillNode* right;
-    
-    SkillNode(string n, int c) : name(n), cost(c), unlocked(false), left(nullptr), right(nullptr) {}
-};
-
-class SkillTree {
-public:
-    SkillNode* root;
-    
-    SkillTree() {
-        // Create skill tree
-        root = new SkillNode("Warrior", 0);
-        root->unlocked = true;
-        root->left = new SkillNode("Shield", 5);
-        root->right = new SkillNode("Sword", 5);
-        root->left->left = new SkillNode("Iron Shield", 10);
-        root->left->right = new SkillNode("Magic Shield", 10);
-        root->right->left = new SkillNode("Fire Sword", 10);
-        root->right->right = new SkillNode("Ice Sword", 10);
-    }
-    
-    bool unlockSkill(SkillNode* node, int& gold) {
-        if (!node || node->unlocked) return false;
-        if (gold >= node->cost) {
-            gold -= node->cost;
-            node->unlocked = true;
-            return true;
-        }
-        return false;
-    }
+// 2. TREE - Skill tree for player upgrades (flat, see skill_tree.h)
+// Used when dungeon_skills.txt is missing
+constexpr SkillDef DEFAULT_SKILLS[] = {
+    {0, "Warrior", 0, 0, SKILL_PASSIVE},
+    {1, "Shield", 5, 0, SKILL_PASSIVE},
+    {2, "Sword", 5, 0, SKILL_PASSIVE},
+    {3, "Iron Shield", 10, 0, SKILL_PASSIVE},
+    {4, "Magic Shield", 10, 0, SKILL_PASSIVE},
+    {5, "Fire Sword", 10, 0, SKILL_PASSIVE},
+    {6, "Ice Sword", 10, 0, SKILL_PASSIVE},
 };
 
 // 3. QUEUE - Event queue for game actions
@@ -131,161 +91,455 @@ public:
     }
 };
 
+// ============ WORLD DATA ============
+
+// Used when dungeon.world is missing; format in world_loader.h
+const char* const DEFAULT_DUNGEON =
+    "N 200 400 0 Entrance\n"
+    "N 350 250 0 Armory\n"
+    "N 350 550 0 Library\n"
+    "N 500 150 0 Treasury\n"
+    "N 500 400 0 Kitchen\n"
+    "N 500 650 0 Crypt\n"
+    "N 650 300 0 Throne Room\n"
+    "N 650 500 0 Garden\n"
+    "N 800 200 0 Tower\n"
+    "N 800 600 0 Dragon Lair\n"
+    "E 0 1\n" "E 0 2\n" "E 1 3\n" "E 1 4\n" "E 2 4\n" "E 2 5\n" "E 3 6\n"
+    "E 4 6\n" "E 4 7\n" "E 5 7\n" "E 6 8\n" "E 7 9\n" "E 8 9\n"
+    "M 3 30\n" "M 5 40\n" "M 8 50\n"
+    "M 9 80\n" // Dragon!
+    "T 3\n" "T 6\n" "T 9\n"
+    "S 0\n"
+    "G 9\n";
+
+// Streams world file records into the dungeon
+struct DungeonWorldSink {
+    DungeonGraph& dungeon;
+    vector<int>& monsterHealth;
+    int startRoom;
+    int goalRoom;
+    
+    DungeonWorldSink(DungeonGraph& d, vector<int>& hp)
+        : dungeon(d), monsterHealth(hp), startRoom(0), goalRoom(-1) {}
+    
+    void reserve(uint64_t rooms, uint64_t corridors) {
+        dungeon.reserve(rooms, corridors);
+        monsterHealth.reserve(rooms);
+    }
+    
+    void node(int x, int y, int, const string& name, const string&) {
+        int id = dungeon.roomCount();
+        dungeon.addRoom(id, name.empty() ? "Room " + to_string(id) : name, x, y);
+        monsterHealth.push_back(0);
+    }
+    
+    void edge(uint32_t a, uint32_t b, float length) { dungeon.connectRooms(a, b, length); }
+    void monster(uint32_t room, int hp) {
+        dungeon.setMonster(room);
+        monsterHealth[room] = hp;
+    }
+    void treasure(uint32_t room) { dungeon.setTreasure(room); }
+    void start(uint32_t room) { startRoom = room; }
+    void goal(uint32_t room) { goalRoom = room; }
+};
+
 // ============ GAME ENGINE ============
+const float ROOM_RADIUS = 25;
+const float ROOM_OUTLINE = 2;
+const int ROOM_VERTICES = 16; // 4 quads per room in roomBatch
+const float TICKS_PER_SECOND = 60;
+const float TOKEN_SPEED = 400; // player token, pixels per second
+const int SKILL_LEVELS = 4;    // tree levels that fit on the skill screen
+const float SKILL_RADIUS = 35;
+const uint32_t SCOUT_HOPS = 16; // treasure further away is not reported
+const uint32_t DANGER_HOPS = 3; // monsters further away are not reported
+
+struct GameOptions {
+    uint64_t seed = 0;
+    unsigned frameCap = 60; // 0 = unlimited
+    bool idle = true;       // block on input while nothing is animating
+    string worldPath = "dungeon.world";
+    int generateRooms = 0;  // > 0: procedural dungeon of this size instead of worldPath
+    string savePath = "dungeon.sav";
+    bool resume = false;       // load savePath on startup
+    float autosaveSeconds = 0; // background checkpoint interval, 0 = off
+    string recordPath;         // command log to write, empty = off
+    bool headless = false;     // replaying: no window, no rendering
+};
+
+// Fixed-size records for the save file (see snapshot.h)
+struct SavedPlayer {
+    int32_t roomCount; // must match the dungeon being resumed
+    int32_t currentRoom;
+    int32_t health;
+    int32_t maxHealth;
+    int32_t gold;
+    int32_t attack;
+};
+
+struct SavedMonster {
+    int32_t room;
+    int32_t hp;
+};
+
 class DungeonGame {
 private:
+    GameOptions options;
     sf::RenderWindow window;
     DungeonGraph dungeon;
     Player player;
     SkillTree skillTree;
+    vector<sf::Vector2f> skillLayout; // screen position per visible slot
     queue<GameEvent> eventQueue; // QUEUE
-    vector<GameEvent> eventLog; // LIST
-    map<int, int> monsterHealth; // ORDERED MAP
+    RingBuffer<GameEvent, 10> eventLog; // RING BUFFER of recent events
+    vector<int> monsterHealth;   // per room, 0 = none left
+    int goalRoom;                // R routes here; treasure here wins
+    DistanceField scoutField;    // hops from the player, up to SCOUT_HOPS
+    int scoutedRoom;             // room scoutField was computed from, -1 = stale
+    uint32_t treasureHops;       // to the nearest treasure, if within SCOUT_HOPS
+    uint32_t dangerHops;         // to the nearest live monster, if within DANGER_HOPS
+    RngService rng;
+    
+    Autocomplete roomSearch; // TRIE over room names
+    bool searching;
+    string searchText;
+    vector<uint32_t> searchHits;
     
     sf::Font font;
     int eventCounter;
     bool showSkillTree;
     
+    // Render batches, built once per dungeon layout
+    CircleAtlas circles;
+    sf::VertexArray edgeBatch;  // each corridor once
+    sf::VertexArray roomBatch;  // per room: outline, fill, monster, treasure
+    GlyphBatch roomLabels;
+    GlyphBatch panelText;
+    GlyphBatch logText;
+    GlyphBatch footerText;
+    bool panelDirty;            // panel text is rebuilt only when set
+    
+    // Player token glides between rooms; render interpolates between ticks
+    sf::Vector2f tokenPrev;
+    sf::Vector2f tokenPos;
+    sf::VertexArray tokenBatch;
+    
+    SpscQueue<string, 16> notices; // messages from the checkpoint thread
+    BackgroundSaver saver;         // declared after notices: joins first
+    float autosaveTimer;
+    int checkpointsPending;        // started, notice not shown yet
+    CommandRecorder recorder;
+    
+#if defined(ENABLE_PROFILER)
+    bool showProfile = false;         // F3 overlay
+    vector<ProfileStat> frameProfile; // zones of the previous frame
+    uint64_t frameStart = 0;          // profiler clock, ns
+    uint64_t frameLength = 0;
+    GlyphBatch profileText{font, 11};
+#endif
+    
 public:
-    DungeonGame() : window(sf::VideoMode(1200, 800), "Dungeon Explorer - Data Structures Game"),
-                    eventCounter(0), showSkillTree(false) {
-        srand(time(0));
-        font.loadFromFile("arial.ttf");
+    DungeonGame(const GameOptions& opts) : options(opts), scoutedRoom(-1), rng(opts.seed), searching(false), eventCounter(0), showSkillTree(false),
+                    edgeBatch(sf::Lines), roomBatch(sf::Quads), roomLabels(font, 12),
+                    panelText(font, 14), logText(font, 11), footerText(font, 12), panelDirty(true),
+                    tokenBatch(sf::Quads), autosaveTimer(0), checkpointsPending(0) {
+        if (!options.headless) {
+            window.create(sf::VideoMode(1200, 800), "Dungeon Explorer - Data Structures Game");
+            font.loadFromFile("arial.ttf");
+            circles.create(ROOM_RADIUS / (ROOM_RADIUS + ROOM_OUTLINE));
+        }
+        if (!skillTree.loadFromFile("dungeon_skills.txt")) skillTree.assign(DEFAULT_SKILLS);
+        layoutSkillTree();
         initializeDungeon();
+        if (!options.headless) buildRenderBatches();
+        tokenPos = tokenPrev = roomCenter(player.currentRoom);
+        cout << "Seed: " << opts.seed << endl;
         addEvent("Welcome to the Dungeon!");
         addEvent("Find treasure and defeat monsters!");
+        if (!options.recordPath.empty()) {
+            string world = options.generateRooms > 0
+                ? "generate:" + to_string(options.generateRooms) : options.worldPath;
+            if (!recorder.open(options.recordPath, "dungeon", opts.seed, world)) {
+                cout << "Cannot record to " << options.recordPath << endl;
+            }
+        }
+        if (options.resume) resume();
     }
     
     void initializeDungeon() {
-        // Create dungeon layout (10 rooms)
-        dungeon.addRoom(0, "Entrance", 200, 400);
-        dungeon.addRoom(1, "Armory", 350, 250);
-        dungeon.addRoom(2, "Library", 350, 550);
-        dungeon.addRoom(3, "Treasury", 500, 150);
-        dungeon.addRoom(4, "Kitchen", 500, 400);
-        dungeon.addRoom(5, "Crypt", 500, 650);
-        dungeon.addRoom(6, "Throne Room", 650, 300);
-        dungeon.addRoom(7, "Garden", 650, 500);
-        dungeon.addRoom(8, "Tower", 800, 200);
-        dungeon.addRoom(9, "Dragon Lair", 800, 600);
-        
-        // Connect rooms
-        dungeon.connectRooms(0, 1);
-        dungeon.connectRooms(0, 2);
-        dungeon.connectRooms(1, 3);
-        dungeon.connectRooms(1, 4);
-        dungeon.connectRooms(2, 4);
-        dungeon.connectRooms(2, 5);
-        dungeon.connectRooms(3, 6);
-        dungeon.connectRooms(4, 6);
-        dungeon.connectRooms(4, 7);
-        dungeon.connectRooms(5, 7);
-        dungeon.connectRooms(6, 8);
-        dungeon.connectRooms(7, 9);
-        dungeon.connectRooms(8, 9);
-        
-        // Add monsters and treasure
-        dungeon.setMonster(3);
-        dungeon.setMonster(5);
-        dungeon.setMonster(8);
-        dungeon.setMonster(9);
-        
-        dungeon.setTreasure(3);
-        dungeon.setTreasure(6);
-        dungeon.setTreasure(9);
-        
-        // Initialize monster health
-        monsterHealth[3] = 30;
-        monsterHealth[5] = 40;
-        monsterHealth[8] = 50;
-        monsterHealth[9] = 80; // Dragon!
-        
-        player.moveHistory.push(0);
-        dungeon.rooms[0].visited = true;
+        DungeonWorldSink sink(dungeon, monsterHealth);
+        WorldLoadStats stats;
+        if (options.generateRooms > 0) {
+            sf::Clock timer;
+            unsigned threads = max(1u, thread::hardware_concurrency());
+            generateDungeon(dungeon, monsterHealth, options.generateRooms, options.seed, threads);
+            cout << "Generated " << dungeon.roomCount() << " rooms, " << dungeon.builder.edges.size()
+                 << " corridors in " << timer.getElapsedTime().asMilliseconds() << " ms on "
+                 << threads << " threads" << endl;
+        } else if (loadWorld(options.worldPath, sink, stats)) {
+            cout << "Loaded " << options.worldPath << ": " << stats.nodes << " rooms, "
+                 << stats.edges << " corridors in " << stats.seconds * 1000 << " ms ("
+                 << stats.megabytesPerSecond() << " MB/s), peak memory "
+                 << stats.peakMemoryKb / 1024 << " MB" << endl;
+        } else {
+            if (stats.bytes > 0) cout << options.worldPath << ": " << stats.error << endl;
+            dungeon = DungeonGraph();
+            monsterHealth.clear();
+            sink.startRoom = 0;
+            sink.goalRoom = -1;
+            parseWorldText(DEFAULT_DUNGEON, sink, stats);
+        }
+        dungeon.freeze();
+        
+        goalRoom = sink.goalRoom >= 0 ? sink.goalRoom : dungeon.roomCount() - 1;
+        player.currentRoom = sink.startRoom;
+        player.moveHistory.push(sink.startRoom);
+        dungeon.visited[sink.startRoom] = true;
+        refreshFields();
+        
+        // Rooms rank by how often they were entered
+        for (int id = 0; id < dungeon.roomCount(); id++) {
+            roomSearch.add(dungeon.names[id], id, 0);
+        }
+        roomSearch.build();
+    }
+    
+    // Only the panel reads the scout, so pickups, kills and loads just mark
+    // it stale and scout() reruns it the next time the panel is built
+    void refreshFields() {
+        scoutedRoom = -1;
+    }
+    
+    // BFS from the player bounded by SCOUT_HOPS: the cost is the rooms
+    // around the player, not the whole map
+    void scout() {
+        if (scoutedRoom == player.currentRoom) return;
+        scoutedRoom = player.currentRoom;
+        scoutField.compute(dungeon.graph, (uint32_t)player.currentRoom, SCOUT_HOPS);
+        treasureHops = dangerHops = DistanceField::UNREACHED;
+        scoutField.forEachReached([&](uint32_t id, uint32_t hops) {
+            if (dungeon.hasTreasure[id]) treasureHops = min(treasureHops, hops);
+            if (hops <= DANGER_HOPS && dungeon.hasMonster[id] && monsterHealth[id] > 0) {
+                dangerHops = min(dangerHops, hops);
+            }
+        });
     }
     
     void addEvent(string msg) {
         eventQueue.push({msg, eventCounter++});
-        if (eventLog.size() >= 10) {
-            eventLog.erase(eventLog.begin());
-        }
-        eventLog.push_back({msg, eventCounter});
+        eventLog.push({msg, eventCounter});
+        panelDirty = true;
     }
     
+    // Fixed-timestep loop: update() always advances by one 1/60 s tick,
+    // render() interpolates between the last two ticks
     void run() {
+        window.setFramerateLimit(options.frameCap);
+        const sf::Time step = sf::seconds(1.0f / TICKS_PER_SECOND);
+        const sf::Time maxLag = sf::seconds(0.25f);
+        const sf::Time idleNap = sf::milliseconds(100);
+        sf::Clock clock;
+        sf::Time lag = sf::Time::Zero;
+        bool firstFrame = true;
+        
         while (window.isOpen()) {
+            // Nothing moving: sleep until input arrives instead of spinning.
+            // Autosave and the saver's notices run on game time, so while
+            // either is pending nap briefly instead and keep ticking.
+            if (options.idle && !firstFrame && !animating()) {
+                if (options.autosaveSeconds > 0 || checkpointsPending > 0) {
+                    sf::sleep(idleNap);
+                } else {
+                    sf::Event event;
+                    if (window.waitEvent(event)) handleEvent(event);
+                    clock.restart();
+                    lag = sf::Time::Zero;
+                }
+            }
+            firstFrame = false;
+#if defined(ENABLE_PROFILER)
+            endProfileFrame();
+#endif
+            
             handleEvents();
-            update();
-            render();
+            
+            lag += clock.restart();
+            if (lag > maxLag) lag = maxLag; // don't spiral after a stall
+            while (lag >= step) {
+                update(step.asSeconds());
+                lag -= step;
+            }
+            
+            render(lag / step);
         }
     }
     
+    // Applies a recorded session as fast as the game logic allows: no
+    // window, no timers, no frames. Same seed and world, same commands,
+    // same game.
+    void replay(const vector<Command>& commands) {
+        auto start = chrono::steady_clock::now();
+        size_t applied = 0;
+        for (; applied < commands.size(); applied++) {
+            const Command& c = commands[applied];
+            // Clicks only reach connected rooms; a jump elsewhere means
+            // the log does not belong to this dungeon
+            if (c.type == CMD_TRAVEL && c.arg < (uint32_t)dungeon.roomCount()
+                && dungeon.areConnected(player.currentRoom, (int)c.arg)) {
+                moveToRoom((int)c.arg);
+            } else if (c.type == CMD_BACKTRACK) {
+                backtrack();
+            } else if (c.type == CMD_USE_ITEM) {
+                useHealthPotion();
+            } else if (c.type == CMD_UNLOCK && c.arg < skillTree.slotCount()) {
+                tryUnlockSkill(c.arg);
+            } else if (c.type == CMD_LOAD) {
+                cout << "Session loaded a save after " << applied
+                     << " commands; the rest cannot be replayed" << endl;
+                break;
+            } else {
+                cout << "Skipping bad command " << commandName(c.type) << " " << c.arg << endl;
+            }
+            while (!eventQueue.empty()) eventQueue.pop();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        
+        int monstersLeft = 0, treasureLeft = 0;
+        for (int id = 0; id < dungeon.roomCount(); id++) {
+            monstersLeft += dungeon.hasMonster[id] && monsterHealth[id] > 0;
+            treasureLeft += dungeon.hasTreasure[id];
+        }
+        cout << "Replayed " << applied << " commands in " << seconds * 1000 << " ms ("
+             << (seconds > 0 ? applied / seconds : 0) << " commands/s)" << endl;
+        cout << "Room: " << dungeon.names[player.currentRoom] << ", HP " << player.health << "/"
+             << player.maxHealth << ", gold " << player.gold << ", attack " << player.attack << endl;
+        cout << "Monsters left: " << monstersLeft << ", treasure left: " << treasureLeft << endl;
+        for (const GameEvent& e : eventLog) cout << "  " << e.message << endl;
+    }
+    
+    bool animating() const {
+        sf::Vector2f target = roomCenter(player.currentRoom);
+        return tokenPos.x != target.x || tokenPos.y != target.y
+            || tokenPrev.x != tokenPos.x || tokenPrev.y != tokenPos.y
+            || !eventQueue.empty();
+    }
+    
     void handleEvents() {
+        PROFILE_ZONE("handleEvents");
         sf::Event event;
         while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
-            
-            if (event.type == sf::Event::KeyPressed) {
-                if (event.key.code == sf::Keyboard::T) {
-                    showSkillTree = !showSkillTree;
-                }
-                if (event.key.code == sf::Keyboard::B && !showSkillTree) {
-                    backtrack();
-                }
-                if (event.key.code == sf::Keyboard::H && !showSkillTree) {
-                    useHealthPotion();
-                }
+            handleEvent(event);
+        }
+    }
+    
+    void handleEvent(const sf::Event& event) {
+        if (event.type == sf::Event::Closed)
+            window.close();
+        
+        panelDirty = true;
+        
+        if (searching) {
+            handleSearchInput(event);
+            return;
+        }
+        
+        if (event.type == sf::Event::KeyPressed) {
+            if (event.key.code == sf::Keyboard::T) {
+                showSkillTree = !showSkillTree;
             }
-            
-            if (event.type == sf::Event::MouseButtonPressed && !showSkillTree) {
-                sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-                handleRoomClick(mousePos.x, mousePos.y);
+            if (event.key.code == sf::Keyboard::B && !showSkillTree) {
+                backtrack();
             }
-            
-            if (event.type == sf::Event::MouseButtonPressed && showSkillTree) {
-                sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-                handleSkillClick(mousePos.x, mousePos.y);
+            if (event.key.code == sf::Keyboard::H && !showSkillTree) {
+                useHealthPotion();
+            }
+            if (event.key.code == sf::Keyboard::R && !showSkillTree) {
+                showRouteTo(goalRoom);
+            }
+            if (event.key.code == sf::Keyboard::Slash && !showSkillTree) {
+                searching = true;
+                searchText.clear();
+                searchHits.clear();
+            }
+            if (event.key.code == sf::Keyboard::F5) {
+                checkpoint();
+            }
+            if (event.key.code == sf::Keyboard::F9) {
+                resume();
             }
+#if defined(ENABLE_PROFILER)
+            if (event.key.code == sf::Keyboard::F3) {
+                showProfile = !showProfile;
+            }
+            if (event.key.code == sf::Keyboard::F4) {
+                bool ok = profiler().writeChromeTrace("dungeon_trace.json");
+                addEvent(ok ? "Trace written to dungeon_trace.json" : "Trace dump failed!");
+            }
+#endif
+        }
+        
+        if (event.type == sf::Event::MouseButtonPressed && !showSkillTree) {
+            sf::Vector2i mousePos = sf::Mouse::getPosition(window);
+            handleRoomClick(mousePos.x, mousePos.y);
+        }
+        
+        if (event.type == sf::Event::MouseButtonPressed && showSkillTree) {
+            sf::Vector2i mousePos = sf::Mouse::getPosition(window);
+            handleSkillClick(mousePos.x, mousePos.y);
         }
     }
     
-    void handleRoomClick(int x, int y) {
-        for (auto& roomPair : dungeon.rooms) {
-            auto pos = dungeon.positions[roomPair.first];
-            int dx = x - pos.first;
-            int dy = y - pos.second;
-            
-            if (sqrt(dx*dx + dy*dy) < 30) {
-                // Check if connected to current room
-                auto& currentRoom = dungeon.rooms[player.currentRoom];
-                for (int connectedId : currentRoom.connections) {
-                    if (connectedId == roomPair.first) {
-                        moveToRoom(roomPair.first);
-                        return;
-                    }
-                }
+    // Typing filters rooms by name; Enter routes to the best match
+    void handleSearchInput(const sf::Event& event) {
+        if (event.type == sf::Event::KeyPressed) {
+            if (event.key.code == sf::Keyboard::Escape) {
+                searching = false;
+            } else if (event.key.code == sf::Keyboard::Enter) {
+                searching = false;
+                if (!searchHits.empty()) showRouteTo(searchHits[0]);
             }
+            return;
         }
+        if (event.type != sf::Event::TextEntered) return;
+        
+        sf::Uint32 c = event.text.unicode;
+        if (c == 8) {
+            if (!searchText.empty()) searchText.pop_back();
+        } else if (c < 128 && (isalnum((int)c) || c == ' ')) {
+            searchText += (char)c;
+        } else {
+            return;
+        }
+        searchHits = searchText.empty() ? vector<uint32_t>() : roomSearch.topK(searchText, 5);
+    }
+    
+    // Closest room under the cursor that is connected to the current room
+    void handleRoomClick(int x, int y) {
+        int target = dungeon.roomAt(x, y, player.currentRoom);
+        if (target >= 0) moveToRoom(target);
     }
     
     void moveToRoom(int roomId) {
+        recorder.record(CMD_TRAVEL, roomId);
         player.currentRoom = roomId;
         player.moveHistory.push(roomId);
-        auto& room = dungeon.rooms[roomId];
+        const string& name = dungeon.names[roomId];
+        roomSearch.setWeight(roomId, roomSearch.weightOf(roomId) + 1);
         
-        if (!room.visited) {
-            room.visited = true;
-            addEvent("Entered " + room.name);
+        if (!dungeon.visited[roomId]) {
+            dungeon.visited[roomId] = true;
+            addEvent("Entered " + name);
             
-            if (room.hasMonster && monsterHealth[roomId] > 0) {
+            if (dungeon.hasMonster[roomId] && monsterHealth[roomId] > 0) {
                 battleMonster(roomId);
-            } else if (room.hasTreasure) {
+            } else if (dungeon.hasTreasure[roomId]) {
                 findTreasure(roomId);
-                room.hasTreasure = false;
+                dungeon.hasTreasure[roomId] = false;
+                refreshFields();
             }
         } else {
-            addEvent("Returned to " + room.name);
+            addEvent("Returned to " + name);
         }
     }
     
@@ -293,22 +547,23 @@ public:
         int& hp = monsterHealth[roomId];
         addEvent("Monster appeared! HP: " + to_string(hp));
         
-        int damage = player.attack + rand() % 10;
+        int damage = player.attack + rng.combat.below(10);
         hp -= damage;
         addEvent("You dealt " + to_string(damage) + " damage!");
         
         if (hp <= 0) {
             addEvent("Monster defeated!");
-            int goldReward = 10 + rand() % 15;
+            refreshFields();
+            int goldReward = 10 + rng.loot.below(15);
             player.gold += goldReward;
             addEvent("Found " + to_string(goldReward) + " gold!");
             
-            if (rand() % 3 == 0) {
+            if (rng.loot.below(3) == 0) {
                 player.addItem("Health Potion");
                 addEvent("Found a Health Potion!");
             }
         } else {
-            int monsterDamage = 5 + rand() % 10;
+            int monsterDamage = 5 + rng.combat.below(10);
             player.takeDamage(monsterDamage);
             addEvent("Took " + to_string(monsterDamage) + " damage!");
             
@@ -319,24 +574,40 @@ public:
     }
     
     void findTreasure(int roomId) {
-        int gold = 20 + rand() % 30;
+        int gold = 20 + rng.loot.below(30);
         player.gold += gold;
         addEvent("Found treasure: " + to_string(gold) + " gold!");
         
-        if (roomId == 9) {
+        if (roomId == goalRoom) {
             addEvent("LEGENDARY TREASURE! You WIN!");
         }
     }
     
     void backtrack() {
+        recorder.record(CMD_BACKTRACK);
         int prevRoom = player.moveHistory.backtrack();
         if (prevRoom != -1) {
             player.currentRoom = prevRoom;
-            addEvent("Backtracked to " + dungeon.rooms[prevRoom].name);
+            addEvent("Backtracked to " + dungeon.names[prevRoom]);
+        }
+    }
+    
+    void showRouteTo(int target) {
+        const string& name = dungeon.names[target];
+        Route route = dungeon.findPath(player.currentRoom, target);
+        if (!route.found()) {
+            addEvent("No route to " + name + "!");
+        } else if (route.path.size() == 1) {
+            addEvent("You are in " + name + "!");
+        } else {
+            addEvent(name + " is " + to_string(route.path.size() - 1) + " rooms away ("
+                     + to_string((int)route.cost) + " paces)");
+            addEvent("Next room: " + dungeon.names[route.path[1]]);
         }
     }
     
     void useHealthPotion() {
+        recorder.record(CMD_USE_ITEM);
         for (size_t i = 0; i < player.inventory.size(); i++) {
             if (player.inventory[i] == "Health Potion") {
                 player.heal(30);
@@ -349,109 +620,262 @@ public:
     }
     
     void handleSkillClick(int x, int y) {
-        // Simple skill tree layout
-        if (tryUnlockSkill(skillTree.root->left, 400, 300, x, y)) return;
-        if (tryUnlockSkill(skillTree.root->right, 700, 300, x, y)) return;
-        if (tryUnlockSkill(skillTree.root->left->left, 300, 450, x, y)) return;
-        if (tryUnlockSkill(skillTree.root->left->right, 500, 450, x, y)) return;
-        if (tryUnlockSkill(skillTree.root->right->left, 600, 450, x, y)) return;
-        if (tryUnlockSkill(skillTree.root->right->right, 800, 450, x, y)) return;
-    }
-    
-    bool tryUnlockSkill(SkillNode* node, int nx, int ny, int x, int y) {
-        if (!node) return false;
-        int dx = x - nx;
-        int dy = y - ny;
-        if (sqrt(dx*dx + dy*dy) < 40) {
-            if (skillTree.unlockSkill(node, player.gold)) {
-                addEvent("Unlocked: " + node->name);
-                player.attack += 5;
-                player.maxHealth += 20;
-                player.health += 20;
-                return true;
-            } else {
-                addEvent("Need " + to_string(node->cost) + " gold!");
+        for (uint32_t i = 0; i < skillLayout.size(); i++) {
+            if (!skillTree.exists(i)) continue;
+            float dx = x - skillLayout[i].x;
+            float dy = y - skillLayout[i].y;
+            if (dx * dx + dy * dy < SKILL_RADIUS * SKILL_RADIUS) {
+                tryUnlockSkill(i);
+                return;
             }
-            return true;
         }
-        return false;
     }
     
-    void update() {
+    void tryUnlockSkill(uint32_t slot) {
+        if (skillTree.unlocked(slot)) return;
+        recorder.record(CMD_UNLOCK, slot);
+        if (skillTree.unlock(slot, player.gold)) {
+            addEvent("Unlocked: " + string(skillTree.name(slot)));
+            player.attack += 5;
+            player.maxHealth += 20;
+            player.health += 20;
+        } else {
+            addEvent("Need " + to_string(skillTree.node(slot).cost) + " gold!");
+        }
+    }
+    
+    // Root at the top; each level down halves the horizontal spread. The
+    // bottom row ends up 100 px apart, so no two nodes' circles overlap.
+    void layoutSkillTree() {
+        uint32_t shown = min(skillTree.slotCount(), (1u << SKILL_LEVELS) - 1);
+        skillLayout.assign(shown, sf::Vector2f(550, 150));
+        for (uint32_t i = 1; i < shown; i++) {
+            int depth = SkillTree::depthOf(i);
+            float spread = 400.0f / (1 << depth);
+            sf::Vector2f parent = skillLayout[SkillTree::parentOf(i)];
+            skillLayout[i] = sf::Vector2f(parent.x + (i % 2 ? -spread : spread), 150 + 150.0f * depth);
+        }
+    }
+    
+    // Copies the game state into a snapshot; cheap enough for the game thread
+    SnapshotWriter snapshot() const {
+        SnapshotWriter out;
+        SavedPlayer p = {dungeon.roomCount(), player.currentRoom, player.health,
+                         player.maxHealth, player.gold, player.attack};
+        out.addValue("PLYR", p);
+        out.addValue("SEED", rng.seed);
+        uint64_t rngState[12];
+        rng.getState(rngState);
+        out.add("RNGS", rngState, 12);
+        
+        out.add("VIST", dungeon.visited);
+        out.add("MONS", dungeon.hasMonster);
+        out.add("TRES", dungeon.hasTreasure);
+        
+        vector<SavedMonster> monsters;
+        for (int id = 0; id < dungeon.roomCount(); id++) {
+            if (dungeon.hasMonster[id]) monsters.push_back({id, monsterHealth[id]});
+        }
+        out.add("MOHP", monsters);
+        
+        // Movement history, bottom of the stack first
+        stack<int> rest = player.moveHistory.history;
+        vector<int32_t> history(rest.size());
+        for (size_t i = history.size(); i-- > 0; rest.pop()) history[i] = rest.top();
+        out.add("HIST", history);
+        
+        out.addStrings("INVT", player.inventory);
+        out.add("SKIL", skillTree.unlockBits());
+        return out;
+    }
+    
+    // Snapshot now, write it to disk on the saver thread
+    void checkpoint() {
+        bool started = saver.save(snapshot(), options.savePath, [this](bool ok) {
+            notices.tryPush(ok ? "Checkpoint saved" : "Checkpoint failed!");
+        });
+        if (started) {
+            checkpointsPending++;
+        } else {
+            addEvent("Still saving last checkpoint...");
+        }
+    }
+    
+    // Everything is checked before anything is applied, so a bad file
+    // leaves the running game untouched
+    bool resume() {
+        sf::Clock timer;
+        SnapshotReader in;
+        SavedPlayer p;
+        const uint64_t* rngState;
+        const uint64_t* skills;
+        const SavedMonster* monsters;
+        const int32_t* history;
+        size_t rngWords, skillWords, monsterCount, historyCount;
+        vector<uint8_t> visited, hasMonster, hasTreasure;
+        vector<string> inventory;
+        uint64_t seed;
+        
+        int rooms = dungeon.roomCount();
+        bool ok = in.open(options.savePath) && in.verify()
+            && in.getValue("PLYR", p) && p.roomCount == rooms
+            && p.currentRoom >= 0 && p.currentRoom < rooms
+            && in.getValue("SEED", seed)
+            && in.get("RNGS", rngState, rngWords) && rngWords == 12
+            && in.get("VIST", visited) && (int)visited.size() == rooms
+            && in.get("MONS", hasMonster) && (int)hasMonster.size() == rooms
+            && in.get("TRES", hasTreasure) && (int)hasTreasure.size() == rooms
+            && in.get("MOHP", monsters, monsterCount)
+            && in.get("HIST", history, historyCount) && historyCount > 0
+            && in.getStrings("INVT", inventory)
+            && in.get("SKIL", skills, skillWords) && skillWords == skillTree.unlockBits().size();
+        for (size_t i = 0; ok && i < monsterCount; i++) {
+            ok = monsters[i].room >= 0 && monsters[i].room < rooms;
+        }
+        for (size_t i = 0; ok && i < historyCount; i++) {
+            ok = history[i] >= 0 && history[i] < rooms;
+        }
+        if (!ok) {
+            addEvent("No usable save in " + options.savePath);
+            return false;
+        }
+        
+        player.currentRoom = p.currentRoom;
+        player.health = p.health;
+        player.maxHealth = p.maxHealth;
+        player.gold = p.gold;
+        player.attack = p.attack;
+        player.inventory = inventory;
+        player.moveHistory.history = stack<int>();
+        for (size_t i = 0; i < historyCount; i++) player.moveHistory.push(history[i]);
+        
+        dungeon.visited = visited;
+        dungeon.hasMonster = hasMonster;
+        dungeon.hasTreasure = hasTreasure;
+        monsterHealth.assign(rooms, 0);
+        for (size_t i = 0; i < monsterCount; i++) monsterHealth[monsters[i].room] = monsters[i].hp;
+        
+        skillTree.restoreUnlocks(skills, skillWords);
+        rng.seed = seed;
+        rng.setState(rngState);
+        refreshFields();
+        recorder.record(CMD_LOAD);
+        
+        tokenPos = tokenPrev = roomCenter(player.currentRoom);
+        searching = false;
+        addEvent("Resumed in " + to_string(timer.getElapsedTime().asMilliseconds()) + " ms");
+        return true;
+    }
+    
+    sf::Vector2f roomCenter(int id) const {
+        auto pos = dungeon.positions[id];
+        return sf::Vector2f(pos.first, pos.second);
+    }
+    
+    // One fixed tick of game time
+    void update(float dt) {
+        PROFILE_ZONE("update");
         // Process event queue
         while (!eventQueue.empty()) {
             eventQueue.pop();
         }
+        
+        string note;
+        while (notices.tryPop(note)) {
+            addEvent(note);
+            checkpointsPending = max(0, checkpointsPending - 1);
+        }
+        
+        if (options.autosaveSeconds > 0) {
+            autosaveTimer += dt;
+            if (autosaveTimer >= options.autosaveSeconds) {
+                autosaveTimer = 0;
+                checkpoint();
+            }
+        }
+        
+        tokenPrev = tokenPos;
+        sf::Vector2f delta = roomCenter(player.currentRoom) - tokenPos;
+        float dist = sqrt(delta.x * delta.x + delta.y * delta.y);
+        float stepLen = TOKEN_SPEED * dt;
+        tokenPos = dist <= stepLen ? tokenPos + delta : tokenPos + delta * (stepLen / dist);
     }
     
-    void render() {
+    // alpha in [0, 1): how far we are between the last tick and the next
+    void render(float alpha) {
+        PROFILE_ZONE("render");
         window.clear(sf::Color(20, 20, 40));
         
         if (showSkillTree) {
             renderSkillTree();
         } else {
-            renderDungeon();
+            renderDungeon(alpha);
         }
         
         window.display();
     }
     
-    void renderDungeon() {
-        // Draw connections
-        for (auto& roomPair : dungeon.rooms) {
-            auto pos1 = dungeon.positions[roomPair.first];
-            for (int connId : roomPair.second.connections) {
+    // Static geometry for the current layout; only colors change per frame
+    void buildRenderBatches() {
+        edgeBatch.clear();
+        roomBatch.clear();
+        roomLabels.clear();
+        
+        sf::Color edgeColor(100, 100, 100);
+        for (int id = 0; id < dungeon.roomCount(); id++) {
+            auto pos1 = dungeon.positions[id];
+            for (uint32_t connId : dungeon.connections(id)) {
+                if ((int)connId < id) continue; // adjacency is symmetric
                 auto pos2 = dungeon.positions[connId];
-                sf::Vertex line[] = {
-                    sf::Vertex(sf::Vector2f(pos1.first, pos1.second), sf::Color(100, 100, 100)),
-                    sf::Vertex(sf::Vector2f(pos2.first, pos2.second), sf::Color(100, 100, 100))
-                };
-                window.draw(line, 2, sf::Lines);
+                edgeBatch.append(sf::Vertex(sf::Vector2f(pos1.first, pos1.second), edgeColor));
+                edgeBatch.append(sf::Vertex(sf::Vector2f(pos2.first, pos2.second), edgeColor));
             }
         }
         
-        // Draw rooms
-        for (auto& roomPair : dungeon.rooms) {
-            auto pos = dungeon.positions[roomPair.first];
-            sf::CircleShape circle(25);
-            circle.setPosition(pos.first - 25, pos.second - 25);
-            
-            if (roomPair.first == player.currentRoom) {
-                circle.setFillColor(sf::Color::Green);
-            } else if (!roomPair.second.visited) {
-                circle.setFillColor(sf::Color(100, 100, 100));
-            } else {
-                circle.setFillColor(sf::Color(50, 50, 150));
-            }
-            
-            circle.setOutlineThickness(2);
-            circle.setOutlineColor(sf::Color::White);
-            window.draw(circle);
-            
-            // Draw indicators
-            if (roomPair.second.hasMonster && monsterHealth[roomPair.first] > 0) {
-                sf::CircleShape monster(8);
-                monster.setPosition(pos.first - 8, pos.second - 40);
-                monster.setFillColor(sf::Color::Red);
-                window.draw(monster);
-            }
-            
-            if (roomPair.second.hasTreasure) {
-                sf::CircleShape treasure(8);
-                treasure.setPosition(pos.first + 20, pos.second - 40);
-                treasure.setFillColor(sf::Color::Yellow);
-                window.draw(treasure);
-            }
+        for (int id = 0; id < dungeon.roomCount(); id++) {
+            auto pos = dungeon.positions[id];
+            sf::Vector2f center(pos.first, pos.second);
+            circles.addRing(roomBatch, center, ROOM_RADIUS + ROOM_OUTLINE, sf::Color::White);
+            circles.addDisc(roomBatch, center, ROOM_RADIUS, roomColor(id));
+            circles.addDisc(roomBatch, center + sf::Vector2f(0, -32), 8, sf::Color::Transparent);
+            circles.addDisc(roomBatch, center + sf::Vector2f(28, -32), 8, sf::Color::Transparent);
+            roomLabels.addText(dungeon.names[id], pos.first - 30, pos.second + 30);
+        }
+    }
+    
+    sf::Color roomColor(int id) {
+        if (id == player.currentRoom) return sf::Color::Green;
+        if (!dungeon.visited[id]) return sf::Color(100, 100, 100);
+        return sf::Color(50, 50, 150);
+    }
+    
+    // Per-frame pass: rewrite vertex colors only where room state changed
+    void updateRoomColors() {
+        for (int id = 0; id < dungeon.roomCount(); id++) {
+            size_t v = (size_t)id * ROOM_VERTICES;
+            sf::Color fill = roomColor(id);
+            sf::Color monster = dungeon.hasMonster[id] && monsterHealth[id] > 0
+                ? sf::Color::Red : sf::Color::Transparent;
+            sf::Color treasure = dungeon.hasTreasure[id] ? sf::Color::Yellow : sf::Color::Transparent;
             
-            // Room name
-            sf::Text text;
-            text.setFont(font);
-            text.setString(roomPair.second.name);
-            text.setCharacterSize(12);
-            text.setFillColor(sf::Color::White);
-            text.setPosition(pos.first - 30, pos.second + 30);
-            window.draw(text);
+            if (roomBatch[v + 4].color != fill) CircleAtlas::setColor(roomBatch, v + 4, fill);
+            if (roomBatch[v + 8].color != monster) CircleAtlas::setColor(roomBatch, v + 8, monster);
+            if (roomBatch[v + 12].color != treasure) CircleAtlas::setColor(roomBatch, v + 12, treasure);
         }
+    }
+    
+    void renderDungeon(float alpha) {
+        updateRoomColors();
+        
+        sf::Vector2f token = tokenPrev + (tokenPos - tokenPrev) * alpha;
+        tokenBatch.clear();
+        circles.addDisc(tokenBatch, token, 7, sf::Color::White);
+        
+        sf::RenderStates circleStates(&circles.texture());
+        window.draw(edgeBatch);
+        window.draw(roomBatch, circleStates);
+        window.draw(tokenBatch, circleStates);
+        roomLabels.draw(window);
         
         // Draw UI Panel
         drawUIPanel();
@@ -466,92 +890,136 @@ public:
         panel.setOutlineColor(sf::Color::White);
         window.draw(panel);
         
-        sf::Text text;
-        text.setFont(font);
-        text.setCharacterSize(14);
-        text.setFillColor(sf::Color::White);
+        if (panelDirty) {
+            buildPanelText();
+            panelDirty = false;
+        }
+        panelText.draw(window);
+        logText.draw(window);
+        footerText.draw(window);
+#if defined(ENABLE_PROFILER)
+        if (showProfile) drawProfileOverlay();
+#endif
+    }
+    
+#if defined(ENABLE_PROFILER)
+    // Called at the top of each frame: the frame that just ended becomes
+    // the one the overlay shows
+    void endProfileFrame() {
+        uint64_t now = profiler().now();
+        profiler().summarize(frameStart, now, frameProfile);
+        frameLength = now - frameStart;
+        frameStart = now;
+    }
+    
+    // Top-left box: last frame's length, then each zone's total time,
+    // call count and longest call, biggest first
+    void drawProfileOverlay() {
+        auto ms = [](uint64_t ns) {
+            char buf[16];
+            snprintf(buf, sizeof(buf), "%.2f", ns / 1e6);
+            return string(buf);
+        };
+        profileText.clear();
+        float y = 15;
+        profileText.addText("frame " + ms(frameLength) + " ms", 15, y, sf::Color::Yellow);
+        for (auto& zone : frameProfile) {
+            y += 14;
+            profileText.addText(string(zone.name) + "  " + ms(zone.total) + " ms  x" + to_string(zone.calls)
+                                + "  max " + ms(zone.longest), 15, y);
+        }
+        
+        sf::RectangleShape box(sf::Vector2f(300, y + 10));
+        box.setPosition(10, 10);
+        box.setFillColor(sf::Color(0, 0, 0, 180));
+        window.draw(box);
+        profileText.draw(window);
+    }
+#endif
+    
+    void buildPanelText() {
+        panelText.clear();
+        logText.clear();
+        footerText.clear();
         
         int y = 25;
         
-        text.setString("=== PLAYER STATUS ===");
-        text.setPosition(960, y);
-        window.draw(text);
+        panelText.addText("=== PLAYER STATUS ===", 960, y);
         y += 30;
         
-        text.setString("HP: " + to_string(player.health) + "/" + to_string(player.maxHealth));
-        text.setPosition(960, y);
-        window.draw(text);
+        panelText.addText("HP: " + to_string(player.health) + "/" + to_string(player.maxHealth), 960, y);
         y += 25;
         
-        text.setString("Gold: " + to_string(player.gold));
-        text.setPosition(960, y);
-        window.draw(text);
+        panelText.addText("Gold: " + to_string(player.gold), 960, y);
         y += 25;
         
-        text.setString("Attack: " + to_string(player.attack));
-        text.setPosition(960, y);
-        window.draw(text);
+        panelText.addText("Attack: " + to_string(player.attack), 960, y);
+        y += 25;
+        
+        scout();
+        panelText.addText(treasureHops == DistanceField::UNREACHED ? "Treasure: none nearby"
+                          : "Treasure: " + to_string(treasureHops) + " rooms away", 960, y);
+        y += 25;
+        
+        panelText.addText(dangerHops == DistanceField::UNREACHED ? "Danger: none nearby"
+                          : "Danger: monster " + to_string(dangerHops) + " rooms away", 960, y);
         y += 35;
         
-        text.setString("=== INVENTORY ===");
-        text.setPosition(960, y);
-        window.draw(text);
+        panelText.addText("=== INVENTORY ===", 960, y);
         y += 25;
         
         for (auto& item : player.inventory) {
-            text.setString("- " + item);
-            text.setPosition(970, y);
-            window.draw(text);
+            panelText.addText("- " + item, 970, y);
             y += 20;
         }
         y += 20;
         
-        text.setString("=== EVENT LOG ===");
-        text.setPosition(960, y);
-        window.draw(text);
+        if (searching) {
+            panelText.addText("Find room: " + searchText + "_", 960, y);
+            y += 20;
+            for (uint32_t id : searchHits) {
+                panelText.addText("> " + dungeon.names[id], 970, y);
+                y += 18;
+            }
+            y += 20;
+        }
+        
+        panelText.addText("=== EVENT LOG ===", 960, y);
         y += 25;
         
         for (auto& evt : eventLog) {
-            text.setString(evt.message);
-            text.setCharacterSize(11);
-            text.setPosition(960, y);
-            window.draw(text);
+            logText.addText(evt.message, 960, y);
             y += 18;
         }
         
         // Data structures indicator
-        y = 680;
-        text.setCharacterSize(12);
-        text.setString("DATA STRUCTURES:");
-        text.setPosition(960, y);
-        window.draw(text);
+        y = 665;
+        footerText.addText("DATA STRUCTURES:", 960, y);
         y += 20;
         
-        text.setString("Graph-Rooms, HashMap-Data");
-        text.setPosition(960, y);
-        window.draw(text);
+        footerText.addText("Graph-Rooms, HashMap-Data", 960, y);
         y += 15;
         
-        text.setString("Stack-History, Queue-Events");
-        text.setPosition(960, y);
-        window.draw(text);
+        footerText.addText("Stack-History, Queue-Events", 960, y);
         y += 15;
         
-        text.setString("List-Inventory, Map-Monsters");
-        text.setPosition(960, y);
-        window.draw(text);
+        footerText.addText("List-Inventory, Map-Monsters", 960, y);
         y += 15;
         
-        text.setString("Tree-Skills (Press T)");
-        text.setPosition(960, y);
-        window.draw(text);
+        footerText.addText("Heap-Routes, Trie-Search (/)", 960, y);
+        y += 15;
+        
+        footerText.addText("Tree-Skills (Press T)", 960, y);
         y += 30;
         
         // Controls
-        text.setCharacterSize(11);
-        text.setString("B-Backtrack H-Heal T-Skills");
-        text.setPosition(960, y);
-        window.draw(text);
+        logText.addText("B-Backtrack H-Heal R-Route T-Skills", 960, y);
+        y += 13;
+#if defined(ENABLE_PROFILER)
+        logText.addText("F5-Save F9-Load F3-Profile F4-Trace", 960, y);
+#else
+        logText.addText("F5-Save F9-Load", 960, y);
+#endif
     }
     
     void renderSkillTree() {
@@ -568,31 +1036,24 @@ public:
         text.setPosition(520, 90);
         window.draw(text);
         
-        // Draw skill tree
-        drawSkillNode(skillTree.root, 550, 150);
-        drawSkillNode(skillTree.root->left, 400, 300);
-        drawSkillNode(skillTree.root->right, 700, 300);
-        drawSkillNode(skillTree.root->left->left, 300, 450);
-        drawSkillNode(skillTree.root->left->right, 500, 450);
-        drawSkillNode(skillTree.root->right->left, 600, 450);
-        drawSkillNode(skillTree.root->right->right, 800, 450);
-        
-        // Draw connections
-        drawLine(550, 150, 400, 300);
-        drawLine(550, 150, 700, 300);
-        drawLine(400, 300, 300, 450);
-        drawLine(400, 300, 500, 450);
-        drawLine(700, 300, 600, 450);
-        drawLine(700, 300, 800, 450);
+        // Draw connections, then nodes on top
+        for (uint32_t i = 1; i < skillLayout.size(); i++) {
+            if (!skillTree.exists(i)) continue;
+            sf::Vector2f parent = skillLayout[SkillTree::parentOf(i)];
+            drawLine(parent.x, parent.y, skillLayout[i].x, skillLayout[i].y);
+        }
+        for (uint32_t i = 0; i < skillLayout.size(); i++) {
+            if (skillTree.exists(i)) drawSkillNode(i, skillLayout[i].x, skillLayout[i].y);
+        }
     }
     
-    void drawSkillNode(SkillNode* node, int x, int y) {
-        if (!node) return;
+    void drawSkillNode(uint32_t slot, int x, int y) {
+        bool unlocked = skillTree.unlocked(slot);
         
-        sf::CircleShape circle(35);
-        circle.setPosition(x - 35, y - 35);
+        sf::CircleShape circle(SKILL_RADIUS);
+        circle.setPosition(x - SKILL_RADIUS, y - SKILL_RADIUS);
         
-        if (node->unlocked) {
+        if (unlocked) {
             circle.setFillColor(sf::Color::Green);
         } else {
             circle.setFillColor(sf::Color(100, 100, 100));
@@ -604,14 +1065,14 @@ public:
         
         sf::Text text;
         text.setFont(font);
-        text.setString(node->name);
+        text.setString(skillTree.name(slot));
         text.setCharacterSize(12);
         text.setFillColor(sf::Color::White);
         text.setPosition(x - 30, y - 10);
         window.draw(text);
         
-        if (!node->unlocked) {
-            text.setString(to_string(node->cost) + "g");
+        if (!unlocked) {
+            text.setString(to_string(skillTree.node(slot).cost) + "g");
             text.setCharacterSize(10);
             text.setPosition(x - 12, y + 5);
             window.draw(text);
@@ -627,8 +1088,64 @@ public:
     }
 };
 
-int main() {
-    DungeonGame game;
-    game.run();
+// Usage: game [--seed N] [--fps N] [--no-idle] [--world FILE | --generate ROOMS]
+//             [--save FILE] [--resume] [--autosave SECONDS]
+//             [--record FILE | --replay FILE]
+int main(int argc, char* argv[]) {
+    GameOptions options;
+    options.seed = seedFromArgs(argc, argv);
+    string replayPath;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--fps" && i + 1 < argc) {
+            options.frameCap = (unsigned)max(0, atoi(argv[++i]));
+        } else if (arg == "--no-idle") {
+            options.idle = false;
+        } else if (arg == "--world" && i + 1 < argc) {
+            options.worldPath = argv[++i];
+        } else if (arg == "--generate" && i + 1 < argc) {
+            long long rooms = atoll(argv[++i]);
+            rooms = min<long long>(rooms, MAX_GENERATED_ROOMS);
+            options.generateRooms = (int)max<long long>(rooms, MIN_GENERATED_ROOMS);
+        } else if (arg == "--save" && i + 1 < argc) {
+            options.savePath = argv[++i];
+        } else if (arg == "--resume") {
+            options.resume = true;
+        } else if (arg == "--autosave" && i + 1 < argc) {
+            options.autosaveSeconds = (float)atof(argv[++i]);
+        } else if (arg == "--record" && i + 1 < argc) {
+            options.recordPath = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        }
+    }
+    
+    // The log says which seed and world the session used
+    CommandLog log;
+    if (!replayPath.empty()) {
+        string error;
+        if (!readCommandLog(replayPath, log, error) || log.game != "dungeon") {
+            cout << replayPath << ": " << (error.empty() ? "not a dungeon session" : error) << endl;
+            return 1;
+        }
+        options.seed = log.seed;
+        if (log.world.compare(0, 9, "generate:") == 0) {
+            options.generateRooms = atoi(log.world.c_str() + 9);
+        } else {
+            options.generateRooms = 0;
+            options.worldPath = log.world;
+        }
+        options.headless = true;
+        options.resume = false;
+        options.recordPath.clear();
+        options.autosaveSeconds = 0;
+    }
+    
+    DungeonGame game(options);
+    if (options.headless) {
+        game.replay(log.commands);
+    } else {
+        game.run();
+    }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,139 @@
+// graph_core.h
+// Shared graph core used by DungeonGraph (game.cpp) and WorldGraph (main.cpp)
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+// ============ CSR GRAPH ============
+
+// Frozen adjacency in Compressed Sparse Row form: the neighbors of node u
+// live in neighbors[offsets[u] .. offsets[u+1]). Node ids are dense 0..n-1.
+class CsrGraph {
+public:
+    std::vector<uint32_t> offsets;   // size nodeCount() + 1
+    std::vector<uint32_t> neighbors; // every adjacency list, back to back
+    std::vector<float> weights;      // edge length, parallel to neighbors
+    
+    struct Range {
+        const uint32_t* first;
+        const uint32_t* last;
+        
+        const uint32_t* begin() const { return first; }
+        const uint32_t* end() const { return last; }
+        size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+        uint32_t operator[](size_t i) const { return first[i]; }
+    };
+    
+    uint32_t nodeCount() const {
+        return offsets.empty() ? 0 : (uint32_t)(offsets.size() - 1);
+    }
+    
+    size_t arcCount() const { return neighbors.size(); }
+    
+    uint32_t degree(uint32_t u) const { return offsets[u + 1] - offsets[u]; }
+    
+    Range neighborsOf(uint32_t u) const {
+        const uint32_t* base = neighbors.data();
+        return {base + offsets[u], base + offsets[u + 1]};
+    }
+    
+    // Weight of the arc stored at neighbors[i]
+    float weightAt(size_t i) const { return weights[i]; }
+};
+
+// Collects undirected weighted edges, then freezes them into a CsrGraph
+class GraphBuilder {
+public:
+    std::vector<std::pair<uint32_t, uint32_t>> edges; // LIST of edges
+    std::vector<float> lengths;                       // parallel to edges
+    
+    void addEdge(uint32_t a, uint32_t b, float length = 1.0f) {
+        edges.push_back({a, b});
+        lengths.push_back(length);
+    }
+    
+    void reserve(size_t edgeCount) {
+        edges.reserve(edgeCount);
+        lengths.reserve(edgeCount);
+    }
+    
+    // Counting sort by source node. Stable, so every adjacency list keeps
+    // the order its edges were added in.
+    CsrGraph freeze(uint32_t nodeCount) const {
+        CsrGraph g;
+        g.offsets.assign(nodeCount + 1, 0);
+        for (auto& e : edges) {
+            g.offsets[e.first + 1]++;
+            g.offsets[e.second + 1]++;
+        }
+        for (uint32_t u = 0; u < nodeCount; u++) {
+            g.offsets[u + 1] += g.offsets[u];
+        }
+        
+        g.neighbors.resize(edges.size() * 2);
+        g.weights.resize(edges.size() * 2);
+        std::vector<uint32_t> cursor(g.offsets.begin(), g.offsets.end() - 1);
+        for (size_t i = 0; i < edges.size(); i++) {
+            auto& e = edges[i];
+            uint32_t a = cursor[e.first]++;
+            uint32_t b = cursor[e.second]++;
+            g.neighbors[a] = e.second;
+            g.neighbors[b] = e.first;
+            g.weights[a] = lengths[i];
+            g.weights[b] = lengths[i];
+        }
+        return g;
+    }
+};
+
+// ============ EDGE SET ============
+
+// Open-addressing hash set of undirected edges, for O(1) "are a and b
+// adjacent?" checks instead of scanning an adjacency list
+class EdgeSet {
+public:
+    void build(const CsrGraph& g) {
+        size_t want = 16;
+        while (want < g.arcCount() * 2) want <<= 1; // load factor <= 1/4 per arc pair
+        table.assign(want, EMPTY);
+        mask = want - 1;
+        for (uint32_t u = 0; u < g.nodeCount(); u++) {
+            for (uint32_t v : g.neighborsOf(u)) {
+                if (u <= v) insert(key(u, v));
+            }
+        }
+    }
+    
+    bool contains(uint32_t a, uint32_t b) const {
+        if (table.empty()) return false;
+        uint64_t k = key(a, b);
+        for (size_t i = slot(k);; i = (i + 1) & mask) {
+            if (table[i] == k) return true;
+            if (table[i] == EMPTY) return false;
+        }
+    }
+    
+private:
+    static constexpr uint64_t EMPTY = ~0ull;
+    std::vector<uint64_t> table;
+    size_t mask = 0;
+    
+    // Smaller id in the high half, so (a, b) and (b, a) share a key
+    static uint64_t key(uint32_t a, uint32_t b) {
+        return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+    }
+    
+    size_t slot(uint64_t k) const {
+        return (size_t)((k * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    }
+    
+    void insert(uint64_t k) {
+        size_t i = slot(k);
+        while (table[i] != EMPTY && table[i] != k) i = (i + 1) & mask;
+        table[i] = k;
+    }
+};
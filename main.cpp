@@ -6,65 +6,65 @@
 #include <QLabel>
 #include <QProgressBar>
 #include <QTextEdit>
+#include <QPlainTextEdit>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
 #include <QTimer>
 #include <QMessageBox>
 #include <QListWidget>
+#include <QListView>
+#include <QAbstractListModel>
+#include <QLineEdit>
+#include <QElapsedTimer>
 #include <vector>
 #include <queue>
 #include <stack>
-#include <unordered_map>
-#include <map>
-#include <set>
 #include <algorithm>
-#include <ctime>
-#include <cstdlib>
+#include <tuple>
+#include <numeric>
+#include <array>
+#include <utility>
+
+#include "graph_core.h"
+#include "routing.h"
+#include "autocomplete.h"
+#include "combat.h"
+#include "rng.h"
+#include "ring_buffer.h"
+#include "skill_tree.h"
+#include "symbol_table.h"
+#include "snapshot.h"
+#include "world_loader.h"
+#include "profiler.h"
+#include "command_log.h"
 
 using namespace std;
 
 // ============ DATA STRUCTURES ============
 
-// 1. TREE - Skill/Ability Tree
-struct SkillNode {
-    QString name;
-    int mpCost;
-    int damage;
-    QString type; // "attack", "heal", "buff"
-    bool unlocked;
-    SkillNode* left;
-    SkillNode* right;
-    
-    SkillNode(QString n, int mp, int dmg, QString t) 
-        : name(n), mpCost(mp), damage(dmg), type(t), unlocked(false), 
-          left(nullptr), right(nullptr) {}
+// 1. TREE - Skill/Ability Tree (flat, see skill_tree.h)
+// Used when rpg_abilities.txt is missing
+constexpr SkillDef DEFAULT_ABILITIES[] = {
+    {0, "Attack", 0, 20, SKILL_ATTACK},
+    {1, "Fire", 10, 35, SKILL_ATTACK},
+    {2, "Heal", 8, 30, SKILL_HEAL},
+    {3, "Firaga", 25, 60, SKILL_AREA},
+    {4, "Thunder", 15, 45, SKILL_ATTACK},
+    {5, "Cura", 20, 50, SKILL_HEAL},
+    {6, "Regen", 12, 5, SKILL_REGEN},
+    {7, "Bio", 14, 4, SKILL_POISON},
+    {9, "Haste", 18, 3, SKILL_HASTE},
+    {11, "Protect", 10, 4, SKILL_SHIELD},
 };
 
-class AbilityTree {
-public:
-    SkillNode* root;
-    
-    AbilityTree() {
-        root = new SkillNode("Attack", 0, 20, "attack");
-        root->unlocked = true;
-        root->left = new SkillNode("Fire", 10, 35, "attack");
-        root->right = new SkillNode("Heal", 8, 30, "heal");
-        root->left->left = new SkillNode("Firaga", 25, 60, "attack");
-        root->left->right = new SkillNode("Thunder", 15, 45, "attack");
-        root->right->left = new SkillNode("Cura", 20, 50, "heal");
-        root->right->right = new SkillNode("Regen", 12, 20, "buff");
-    }
-    
-    void getUnlockedSkills(SkillNode* node, vector<SkillNode*>& skills) {
-        if (!node) return;
-        if (node->unlocked) skills.push_back(node);
-        getUnlockedSkills(node->left, skills);
-        getUnlockedSkills(node->right, skills);
-    }
-};
+// Every encounter is one of these, scaled by the location's enemy level
+constexpr const char* ENEMY_NAMES[] = {"Goblin", "Wolf", "Skeleton", "Orc", "Dragon"};
 
 // 2. Character Stats
+const Symbol ITEM_POTION = symbols().intern("Potion");
+const Symbol ITEM_ETHER = symbols().intern("Ether");
+
 struct Character {
     QString name;
     int hp;
@@ -76,16 +76,14 @@ struct Character {
     int attack;
     int defense;
     bool isPlayer;
-    vector<QString> statusEffects; // LIST
-    map<QString, int> inventory; // MAP
+    SymbolMap<int> inventory; // MAP item symbol -> count
     
     Character(QString n, int h, int m, int atk, int def, bool player = true)
         : name(n), hp(h), maxHp(h), mp(m), maxMp(m), level(1), exp(0),
           attack(atk), defense(def), isPlayer(player) {}
     
-    void takeDamage(int dmg) {
-        int actualDmg = max(1, dmg - defense);
-        hp = max(0, hp - actualDmg);
+    void takeDamage(int dmg, int bonusDefense = 0) {
+        hp = max(0, hp - mitigatedDamage(dmg, defense + bonusDefense));
     }
     
     void heal(int amount) {
@@ -102,103 +100,342 @@ struct Character {
     void levelUp() {
         level++;
         exp = 0;
-        maxHp += 20;
-        maxMp += 10;
-        attack += 5;
-        defense += 3;
+        maxHp += HERO_CURVE.perLevel.hp;
+        maxMp += HERO_CURVE.perLevel.mp;
+        attack += HERO_CURVE.perLevel.attack;
+        defense += HERO_CURVE.perLevel.defense;
         hp = maxHp;
         mp = maxMp;
     }
 };
 
+// Fixed-size record for the save file (see snapshot.h)
+struct SavedHero {
+    int32_t locationCount; // must match the world being resumed
+    uint32_t currentLocation;
+    int32_t hp, maxHp, mp, maxMp;
+    int32_t level, exp, attack, defense;
+};
+
+const char* const SAVE_PATH = "rpg.sav";
+
 // 3. GRAPH - World Map connections
+// Locations get dense node ids; descriptions and levels are parallel arrays
+// Used when rpg.world is missing; format in world_loader.h.
+// Road lengths are in leagues.
+const char* const DEFAULT_WORLD =
+    "N 0 0 1 Starting Village|A peaceful village where your journey begins.\n"
+    "N 0 0 2 Forest Path|A winding path through dense trees.\n"
+    "N 0 0 4 Dark Woods|Dangerous woods filled with monsters.\n"
+    "N 0 0 3 Crystal Cave|A mystical cave with glowing crystals.\n"
+    "N 0 0 3 Old Mine|An abandoned mine with treasures.\n"
+    "N 0 0 5 Ancient Ruins|Crumbling ruins of an ancient civilization.\n"
+    "N 0 0 5 Mountain Peak|The highest point with a breathtaking view.\n"
+    "N 0 0 7 Final Castle|The dark lord's fortress.\n"
+    "E 0 1 4\n"
+    "E 0 4 6\n"
+    "E 1 2 5\n"
+    "E 1 3 7\n"
+    "E 2 5 8\n"
+    "E 3 6 9\n"
+    "E 4 5 6\n"
+    "E 5 7 10\n"
+    "E 6 7 5\n"
+    "S 0\n"
+    "G 7\n";
+
 class WorldGraph {
 public:
-    unordered_map<QString, vector<QString>> connections; // HASHMAP
-    unordered_map<QString, QString> locationDesc; // HASHMAP
-    unordered_map<QString, int> enemyLevel; // HASHMAP
-    
-    WorldGraph() {
-        // Define locations
-        connections["Starting Village"] = {"Forest Path", "Old Mine"};
-        connections["Forest Path"] = {"Starting Village", "Dark Woods", "Crystal Cave"};
-        connections["Dark Woods"] = {"Forest Path", "Ancient Ruins"};
-        connections["Crystal Cave"] = {"Forest Path", "Mountain Peak"};
-        connections["Old Mine"] = {"Starting Village", "Ancient Ruins"};
-        connections["Ancient Ruins"] = {"Dark Woods", "Old Mine", "Final Castle"};
-        connections["Mountain Peak"] = {"Crystal Cave", "Final Castle"};
-        connections["Final Castle"] = {"Ancient Ruins", "Mountain Peak"};
-        
-        locationDesc["Starting Village"] = "A peaceful village where your journey begins.";
-        locationDesc["Forest Path"] = "A winding path through dense trees.";
-        locationDesc["Dark Woods"] = "Dangerous woods filled with monsters.";
-        locationDesc["Crystal Cave"] = "A mystical cave with glowing crystals.";
-        locationDesc["Old Mine"] = "An abandoned mine with treasures.";
-        locationDesc["Ancient Ruins"] = "Crumbling ruins of an ancient civilization.";
-        locationDesc["Mountain Peak"] = "The highest point with a breathtaking view.";
-        locationDesc["Final Castle"] = "The dark lord's fortress.";
-        
-        enemyLevel["Starting Village"] = 1;
-        enemyLevel["Forest Path"] = 2;
-        enemyLevel["Dark Woods"] = 4;
-        enemyLevel["Crystal Cave"] = 3;
-        enemyLevel["Old Mine"] = 3;
-        enemyLevel["Ancient Ruins"] = 5;
-        enemyLevel["Mountain Peak"] = 5;
-        enemyLevel["Final Castle"] = 7;
+    static constexpr uint32_t NO_LOCATION = 0xFFFFFFFFu;
+    
+    SymbolMap<uint32_t> index{NO_LOCATION}; // name symbol -> node id
+    vector<QString> names;                  // display names, by node id
+    vector<QString> locationDesc;
+    vector<int> enemyLevel;
+    vector<uint32_t> visits;
+    
+    GraphBuilder builder;
+    CsrGraph graph;
+    Autocomplete search; // TRIE over location names
+    
+    uint32_t start = 0; // where new games begin
+    uint32_t goal = 0;  // the Route button's destination
+    
+    // Streams a world file into the graph; on failure error says why and
+    // the built-in world is loaded instead
+    bool load(const string& path, WorldLoadStats& stats) {
+        WorldSink sink(*this);
+        if (loadWorld(path, sink, stats)) {
+            finishLoad(sink);
+            return true;
+        }
+        *this = WorldGraph();
+        WorldLoadStats builtIn;
+        WorldSink fallback(*this);
+        parseWorldText(DEFAULT_WORLD, fallback, builtIn);
+        finishLoad(fallback);
+        return false;
     }
-};
-
-// 4. PRIORITY QUEUE - Turn-based battle system
-struct BattleTurn {
-    bool isPlayer;
-    int speed;
     
-    bool operator<(const BattleTurn& other) const {
-        return speed < other.speed; // Higher speed goes first
+    uint32_t addLocation(QString name, QString desc, int level) {
+        uint32_t id = (uint32_t)names.size();
+        index[symbols().intern(name.toStdString())] = id;
+        names.push_back(name);
+        locationDesc.push_back(desc);
+        enemyLevel.push_back(level);
+        visits.push_back(0);
+        return id;
+    }
+    
+    void reserve(size_t locations, size_t roads) {
+        names.reserve(locations);
+        locationDesc.reserve(locations);
+        enemyLevel.reserve(locations);
+        visits.reserve(locations);
+        builder.reserve(roads);
+    }
+    
+    void freeze() {
+        graph = builder.freeze((uint32_t)names.size());
+        search = Autocomplete();
+        for (uint32_t id = 0; id < names.size(); id++) {
+            search.add(names[id].toStdString(), id, searchWeight(id));
+        }
+        search.build();
+    }
+    
+    // Frequently visited places rank first, then the more dangerous ones
+    uint32_t searchWeight(uint32_t id) const { return visits[id] * 10 + enemyLevel[id]; }
+    
+    void recordVisit(uint32_t id) {
+        visits[id]++;
+        search.setWeight(id, searchWeight(id));
+    }
+    
+    // Visit counts from a save file; one per location
+    void restoreVisits(const vector<uint32_t>& counts) {
+        visits = counts;
+        for (uint32_t id = 0; id < visits.size(); id++) {
+            search.setWeight(id, searchWeight(id));
+        }
+    }
+    
+    // Interns nothing; NO_LOCATION for unknown names
+    uint32_t idOf(const QString& name) const {
+        return index.get(symbols().find(name.toStdString()));
+    }
+    
+    CsrGraph::Range connections(uint32_t id) const { return graph.neighborsOf(id); }
+    
+    // A location has a handful of roads, so a scan beats a lookup table
+    bool areConnected(uint32_t a, uint32_t b) const {
+        CsrGraph::Range roads = connections(a);
+        return find(roads.begin(), roads.end(), b) != roads.end();
+    }
+    
+    // Shortest route by road distance (Dijkstra)
+    Route route(uint32_t from, uint32_t to) const {
+        return dijkstra(graph, from, to);
+    }
+    
+private:
+    // Streams world file records into this graph
+    struct WorldSink {
+        WorldGraph& world;
+        int64_t startId = -1;
+        int64_t goalId = -1;
+        
+        explicit WorldSink(WorldGraph& w) : world(w) {}
+        
+        void reserve(uint64_t locations, uint64_t roads) { world.reserve(locations, roads); }
+        
+        void node(int, int, int level, const string& name, const string& desc) {
+            QString n = name.empty() ? QString("Location %1").arg(world.names.size())
+                                     : QString::fromStdString(name);
+            world.addLocation(n, QString::fromStdString(desc), level);
+        }
+        
+        void edge(uint32_t a, uint32_t b, float length) {
+            world.builder.addEdge(a, b, length < 0 ? 1.0f : length);
+        }
+        
+        void monster(uint32_t, int) {}
+        void treasure(uint32_t) {}
+        void start(uint32_t id) { startId = id; }
+        void goal(uint32_t id) { goalId = id; }
+    };
+    
+    void finishLoad(const WorldSink& sink) {
+        freeze();
+        start = sink.startId >= 0 ? (uint32_t)sink.startId : 0;
+        goal = sink.goalId >= 0 ? (uint32_t)sink.goalId : (uint32_t)names.size() - 1;
     }
 };
 
-// 5. Battle Log using QUEUE
+// 4. PRIORITY QUEUE - Turn-based battle system (BattleScheduler, see combat.h)
+
+// 5. Battle Log using a RING BUFFER
 class BattleLog {
 public:
-    queue<QString> messages; // QUEUE
+    RingBuffer<QString, 100> messages; // last 100 messages
+    SpscQueue<QString, 256> inbox;     // lines posted from another thread
     
     void addMessage(QString msg) {
-        messages.push(msg);
-        if (messages.size() > 100) {
-            messages.pop();
+        messages.push(std::move(msg));
+    }
+    
+    // Safe to call from one worker thread (e.g. a simulation) while the
+    // UI thread reads; the UI picks the lines up in drain()
+    bool post(QString msg) {
+        return inbox.tryPush(std::move(msg));
+    }
+    
+    void drain() {
+        QString msg;
+        while (inbox.tryPop(msg)) {
+            messages.push(std::move(msg));
         }
     }
     
-    QString getRecent() {
-        QString result;
-        queue<QString> temp = messages;
-        int count = 0;
-        while (!temp.empty() && count < 10) {
-            result += temp.front() + "\n";
-            temp.pop();
-            count++;
+    // Messages pushed since totalPushed() was `seen`, oldest first. Only
+    // the last 100 are kept, so fewer than that many may come back.
+    RingBuffer<QString, 100>::View since(uint64_t seen) {
+        drain();
+        return messages.recent((size_t)min<uint64_t>(messages.totalPushed() - seen, 100));
+    }
+    
+    uint64_t totalPushed() const { return messages.totalPushed(); }
+};
+
+// ============ LIST MODELS ============
+
+// Neighbours of one location, read straight from the CSR graph. Rows are
+// formatted only when the view asks for them, i.e. when they scroll into
+// sight. Qt::UserRole is the destination's node id.
+class LocationListModel : public QAbstractListModel {
+public:
+    LocationListModel(const WorldGraph& map, const vector<uint8_t>& visitedFlags)
+        : world(map), visited(visitedFlags) {}
+    
+    void setLocation(uint32_t id) {
+        beginResetModel();
+        location = id;
+        endResetModel();
+    }
+    
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() || location == WorldGraph::NO_LOCATION
+            ? 0 : (int)world.graph.degree(location);
+    }
+    
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override {
+        if (!index.isValid() || index.row() >= rowCount()) return QVariant();
+        uint32_t id = world.connections(location)[index.row()];
+        if (role == Qt::UserRole) return id;
+        if (role == Qt::DisplayRole) {
+            return QString(visited[id] ? "✓ " : "? ") + world.names[id];
         }
-        return result;
+        return QVariant();
+    }
+    
+private:
+    const WorldGraph& world;
+    const vector<uint8_t>& visited;
+    uint32_t location = WorldGraph::NO_LOCATION;
+};
+
+// Unlocked abilities in slot order, plus the ones that can be learned
+// next when there are skill points to spend. Qt::UserRole is the skill
+// tree slot.
+class AbilityListModel : public QAbstractListModel {
+public:
+    explicit AbilityListModel(const SkillTree& skills) : tree(skills) {}
+    
+    // Call after abilities are unlocked or skill points change
+    void refresh(bool withLearnable) {
+        beginResetModel();
+        rows.clear();
+        tree.forEachUnlocked([&](uint32_t slot) {
+            rows.push_back(slot);
+            if (!withLearnable) return;
+            for (uint32_t child : {SkillTree::leftChild(slot), SkillTree::rightChild(slot)}) {
+                if (tree.learnable(child)) rows.push_back(child);
+            }
+        });
+        sort(rows.begin(), rows.end());
+        endResetModel();
+    }
+    
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : (int)rows.size();
+    }
+    
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override {
+        if (!index.isValid() || index.row() >= rowCount()) return QVariant();
+        uint32_t slot = rows[index.row()];
+        if (role == Qt::UserRole) return slot;
+        if (role == Qt::DisplayRole) {
+            const SkillNode& skill = tree.node(slot);
+            return QString("%1%2 (MP: %3, Power: %4)")
+                .arg(tree.unlocked(slot) ? "" : "Learn ").arg(tree.name(slot))
+                .arg(skill.cost).arg(skill.power);
+        }
+        return QVariant();
     }
+    
+private:
+    const SkillTree& tree;
+    vector<uint32_t> rows;
 };
 
 // ============ MAIN GAME WINDOW ============
+
+// The inputs a widget was last drawn from. changed() stores the new
+// inputs and says whether the widget needs redrawing.
+template <class... T>
+class Shown {
+public:
+    bool changed(const T&... now) {
+        tuple<T...> next(now...);
+        if (valid && next == last) return false;
+        last = std::move(next);
+        valid = true;
+        return true;
+    }
+    
+    void reset() { valid = false; }
+    
+private:
+    tuple<T...> last;
+    bool valid = false;
+};
+
 class FantasyRPG : public QMainWindow {
     Q_OBJECT
     
 private:
     // Data structures
     Character* player;
-    Character* currentEnemy;
-    AbilityTree abilityTree;
+    CombatantBatch enemies;     // SoA pool of the current encounter
+    const char* enemyName;      // from ENEMY_NAMES; a group is all one kind and level
+    int groupLevel;
+    uint32_t enemiesLeft;       // still standing
+    uint32_t enemyFront;        // first one standing; single attacks hit it
+    vector<uint32_t> attackers; // scratch for one enemy volley
+    StatusPool heroStatus;      // BITSET + durations, one unit: the hero
+    StatusPool enemyStatus;     // same, alongside enemies
+    SkillTree abilityTree;
     WorldGraph worldMap;
     BattleLog battleLog;
+    RngService rng;
+    BackgroundSaver saver; // after battleLog: joins before it goes away
     
-    QString currentLocation;
-    set<QString> visitedLocations; // SET
-    stack<QString> locationHistory; // STACK
+    uint32_t currentLocation;         // WorldGraph node id
+    vector<uint8_t> visitedLocations; // SET as a flag per node id
+    stack<uint32_t> locationHistory;  // STACK
+    
+    LocationListModel locationModel;
+    AbilityListModel abilityModel;
     
     // UI Elements
     QWidget* centralWidget;
@@ -210,43 +447,158 @@ private:
     QProgressBar* enemyHPBar;
     QLabel* playerStatsLabel;
     QLabel* enemyStatsLabel;
-    QTextEdit* battleLogText;
-    QListWidget* abilityList;
-    QListWidget* locationList;
+    QPlainTextEdit* battleLogText;
+    QListView* abilityList;
+    QListView* locationList;
+    QLineEdit* searchBox;
+    QListWidget* searchResults;
     QPushButton* attackBtn;
     QPushButton* defendBtn;
     QPushButton* itemBtn;
     QPushButton* skillTreeBtn;
     QPushButton* backtrackBtn;
+    QPushButton* routeBtn;
+    QPushButton* saveBtn;
+    QPushButton* loadBtn;
     QLabel* dataStructLabel;
     
+    // What each widget currently shows; updateUI skips unchanged ones
+    Shown<QString, int, int> shownPlayerName;
+    Shown<int, int> shownPlayerHP;
+    Shown<int, int> shownPlayerMP;
+    Shown<int, int, uint8_t> shownPlayerStats;
+    Shown<bool, const char*, int, uint32_t> shownEnemyName;
+    Shown<int, int> shownEnemyHP;
+    Shown<int, int, uint8_t> shownEnemyStats;
+    Shown<uint32_t> shownLocation;
+    Shown<bool, bool, bool, bool> shownButtons;
+    Shown<uint32_t> shownLocationList;
+    Shown<size_t, bool> shownAbilityList;
+    uint64_t shownLogLines = 0; // battleLog.totalPushed() at last update
+    
     bool inBattle;
-    QTimer* battleTimer;
+    bool heroTurn;           // waiting for the player's move
+    int guardBonus;          // defense from Defend, until the hero's next turn
+    BattleScheduler turns;   // PRIORITY QUEUE of turns in virtual time
+    QTimer* battleTimer;     // GUI only: waits out the delay before an enemy turn
+    
+    // Session recording (see command_log.h). A replay never enters the
+    // event loop, so timers never fire; what they did comes from the log.
+    string worldName;
+    CommandRecorder recorder;
+    bool replaying;
     
 public:
-    FantasyRPG(QWidget *parent = nullptr) : QMainWindow(parent) {
-        srand(time(0));
+    FantasyRPG(uint64_t seed, const string& worldPath, bool replay = false, QWidget *parent = nullptr)
+                : QMainWindow(parent), rng(seed), locationModel(worldMap, visitedLocations),
+                  abilityModel(abilityTree), worldName(worldPath), replaying(replay) {
         
         setWindowTitle("Fantasy Quest - Final Fantasy Style RPG");
         setMinimumSize(1000, 700);
         
         // Initialize game data
-        player = new Character("Hero", 100, 50, 20, 10, true);
-        player->inventory["Potion"] = 3;
-        player->inventory["Ether"] = 2;
+        CombatStats hero = heroStatsForLevel(1);
+        player = new Character("Hero", hero.hp, hero.mp, hero.attack, hero.defense, true);
+        player->inventory[ITEM_POTION] = 3;
+        player->inventory[ITEM_ETHER] = 2;
+        
+        if (!abilityTree.loadFromFile("rpg_abilities.txt")) abilityTree.assign(DEFAULT_ABILITIES);
+        
+        WorldLoadStats load;
+        if (worldMap.load(worldPath, load)) {
+            battleLog.addMessage(QString("Loaded %1: %2 locations, %3 roads in %4 ms (%5 MB/s, peak %6 MB)")
+                .arg(QString::fromStdString(worldPath)).arg(load.nodes).arg(load.edges)
+                .arg(load.seconds * 1000, 0, 'f', 1).arg(load.megabytesPerSecond(), 0, 'f', 1)
+                .arg(load.peakMemoryKb / 1024));
+        } else if (load.bytes > 0) {
+            battleLog.addMessage(QString("%1: %2").arg(QString::fromStdString(worldPath))
+                .arg(QString::fromStdString(load.error)));
+        }
         
-        currentLocation = "Starting Village";
-        visitedLocations.insert(currentLocation);
+        currentLocation = worldMap.start;
+        visitedLocations.assign(worldMap.names.size(), 0);
+        visitedLocations[currentLocation] = 1;
         locationHistory.push(currentLocation);
         
-        currentEnemy = nullptr;
+        groupLevel = 0;
+        enemiesLeft = 0;
+        enemyFront = 0;
         inBattle = false;
+        heroTurn = false;
+        guardBonus = 0;
+        
+        // Sized once for the largest group; encounters only recycle these
+        enemies.reserve(MAX_ENEMY_GROUP);
+        enemyStatus.reserve(MAX_ENEMY_GROUP);
+        heroStatus.assign(1);
+        attackers.reserve(MAX_ENEMY_GROUP);
+        turns.reserve(MAX_ENEMY_GROUP + 1);
+        
+        battleLog.addMessage(QString("Seed: %1").arg(seed));
         
         setupUI();
         updateUI();
         
         battleTimer = new QTimer(this);
-        connect(battleTimer, &QTimer::timeout, this, &FantasyRPG::enemyTurn);
+        battleTimer->setSingleShot(true);
+        connect(battleTimer, &QTimer::timeout, this, [this]() {
+            enemyTurn();
+            advanceBattle();
+        });
+    }
+    
+    bool startRecording(const string& path) {
+        return recorder.open(path, "rpg", rng.seed, worldName);
+    }
+    
+    // Applies a recorded session with no window and no timers; returns a
+    // summary of where it ended up
+    QString replay(const vector<Command>& commands) {
+        QElapsedTimer timer;
+        timer.start();
+        size_t applied = 0;
+        QString stopped;
+        for (; applied < commands.size(); applied++) {
+            const Command& c = commands[applied];
+            // Travel is only offered along a road, so a log that jumps
+            // elsewhere was edited or recorded against another world
+            if (c.type == CMD_TRAVEL && c.arg < worldMap.names.size()
+                && worldMap.areConnected(currentLocation, c.arg)) {
+                travelTo(c.arg);
+            } else if (c.type == CMD_BACKTRACK) {
+                onBacktrack();
+            } else if (c.type == CMD_ATTACK) {
+                onAttack();
+            } else if (c.type == CMD_DEFEND) {
+                onDefend();
+            } else if (c.type == CMD_USE_ITEM) {
+                onUseItem();
+            } else if (c.type == CMD_ABILITY) {
+                useAbility(c.arg);
+            } else if (c.type == CMD_UNLOCK) {
+                learnAbility(c.arg);
+            } else if (c.type == CMD_LOAD) {
+                stopped = QString("Session loaded a save after %1 commands; the rest cannot be replayed\n")
+                    .arg(applied);
+                break;
+            } else {
+                battleLog.addMessage(QString("Skipping bad command %1 %2").arg(commandName(c.type)).arg(c.arg));
+            }
+        }
+        double ms = timer.nsecsElapsed() / 1e6;
+        
+        QString recent;
+        for (const QString& msg : battleLog.since(battleLog.totalPushed() - min<uint64_t>(battleLog.totalPushed(), 10))) {
+            recent += "  " + msg + "\n";
+        }
+        return stopped + QString("Replayed %1 commands in %2 ms (%3 commands/s)\n")
+                .arg(applied).arg(ms, 0, 'f', 1).arg(ms > 0 ? applied * 1000.0 / ms : 0, 0, 'f', 0)
+            + QString("%1 - Level %2 (EXP: %3), HP %4/%5, MP %6/%7\n")
+                .arg(player->name).arg(player->level).arg(player->exp)
+                .arg(player->hp).arg(player->maxHp).arg(player->mp).arg(player->maxMp)
+            + QString("Location: %1%2\n").arg(worldMap.names[currentLocation])
+                .arg(inBattle && enemiesLeft > 0 ? QString(", fighting %1").arg(groupLabel()) : QString())
+            + recent;
     }
     
     void setupUI() {
@@ -310,8 +662,9 @@ public:
         QLabel* logLabel = new QLabel("Battle Log:");
         leftLayout->addWidget(logLabel);
         
-        battleLogText = new QTextEdit();
+        battleLogText = new QPlainTextEdit();
         battleLogText->setReadOnly(true);
+        battleLogText->setMaximumBlockCount(100);
         battleLogText->setMaximumHeight(150);
         leftLayout->addWidget(battleLogText);
         
@@ -343,8 +696,10 @@ public:
         skillsLabel->setStyleSheet("font-weight: bold; font-size: 14px; margin-top: 10px;");
         rightLayout->addWidget(skillsLabel);
         
-        abilityList = new QListWidget();
-        connect(abilityList, &QListWidget::itemDoubleClicked, this, &FantasyRPG::onUseAbility);
+        abilityList = new QListView();
+        abilityList->setModel(&abilityModel);
+        abilityList->setUniformItemSizes(true);
+        connect(abilityList, &QListView::doubleClicked, this, &FantasyRPG::onUseAbility);
         rightLayout->addWidget(abilityList);
         
         skillTreeBtn = new QPushButton("🌳 View Skill Tree");
@@ -356,8 +711,22 @@ public:
         travelLabel->setStyleSheet("font-weight: bold; font-size: 14px; margin-top: 10px;");
         rightLayout->addWidget(travelLabel);
         
-        locationList = new QListWidget();
-        connect(locationList, &QListWidget::itemDoubleClicked, this, &FantasyRPG::onTravel);
+        searchBox = new QLineEdit();
+        searchBox->setPlaceholderText("🔍 Find a location...");
+        connect(searchBox, &QLineEdit::textEdited, this, &FantasyRPG::onSearch);
+        rightLayout->addWidget(searchBox);
+        
+        searchResults = new QListWidget();
+        searchResults->setMaximumHeight(90);
+        connect(searchResults, &QListWidget::itemDoubleClicked, this, &FantasyRPG::onSearchPick);
+        rightLayout->addWidget(searchResults);
+        
+        // Uniform row heights let the view lay out only the visible rows
+        locationList = new QListView();
+        locationList->setModel(&locationModel);
+        locationList->setUniformItemSizes(true);
+        locationList->setLayoutMode(QListView::Batched);
+        connect(locationList, &QListView::doubleClicked, this, &FantasyRPG::onTravel);
         rightLayout->addWidget(locationList);
         
         backtrackBtn = new QPushButton("↶ Backtrack");
@@ -365,6 +734,20 @@ public:
         connect(backtrackBtn, &QPushButton::clicked, this, &FantasyRPG::onBacktrack);
         rightLayout->addWidget(backtrackBtn);
         
+        routeBtn = new QPushButton("🧭 Route to " + worldMap.names[worldMap.goal]);
+        routeBtn->setStyleSheet("QPushButton { background-color: #16a085; color: white; padding: 8px; } QPushButton:hover { background-color: #138d75; }");
+        connect(routeBtn, &QPushButton::clicked, this, &FantasyRPG::onShowRoute);
+        rightLayout->addWidget(routeBtn);
+        
+        QHBoxLayout* saveRow = new QHBoxLayout();
+        saveBtn = new QPushButton("💾 Save");
+        connect(saveBtn, &QPushButton::clicked, this, &FantasyRPG::onSave);
+        saveRow->addWidget(saveBtn);
+        loadBtn = new QPushButton("📂 Load");
+        connect(loadBtn, &QPushButton::clicked, this, &FantasyRPG::onLoad);
+        saveRow->addWidget(loadBtn);
+        rightLayout->addLayout(saveRow);
+        
         // Data structures label
         dataStructLabel = new QLabel();
         dataStructLabel->setStyleSheet("font-size: 10px; color: #7f8c8d; margin-top: 10px;");
@@ -378,334 +761,769 @@ public:
         updateDataStructuresInfo();
     }
     
+    // Touches only the widgets whose inputs changed since the last call,
+    // and appends new battle log lines instead of resetting the text
     void updateUI() {
+        PROFILE_ZONE("updateUI");
         // Update player info
-        playerNameLabel->setText(QString("%1 - Level %2 (EXP: %3/%4)")
-            .arg(player->name).arg(player->level).arg(player->exp).arg(player->level * 100));
-        
-        playerHPBar->setMaximum(player->maxHp);
-        playerHPBar->setValue(player->hp);
-        playerHPBar->setFormat(QString("%1/%2").arg(player->hp).arg(player->maxHp));
-        
-        playerMPBar->setMaximum(player->maxMp);
-        playerMPBar->setValue(player->mp);
-        playerMPBar->setFormat(QString("%1/%2").arg(player->mp).arg(player->maxMp));
-        
-        playerStatsLabel->setText(QString("ATK: %1 | DEF: %2")
-            .arg(player->attack).arg(player->defense));
-        
-        // Update enemy info
-        if (currentEnemy) {
-            enemyNameLabel->setText(QString("%1 - Level %2")
-                .arg(currentEnemy->name).arg(currentEnemy->level));
-            enemyHPBar->setMaximum(currentEnemy->maxHp);
-            enemyHPBar->setValue(currentEnemy->hp);
-            enemyHPBar->setFormat(QString("%1/%2").arg(currentEnemy->hp).arg(currentEnemy->maxHp));
-            enemyStatsLabel->setText(QString("ATK: %1 | DEF: %2")
-                .arg(currentEnemy->attack).arg(currentEnemy->defense));
-        } else {
+        if (shownPlayerName.changed(player->name, player->level, player->exp)) {
+            playerNameLabel->setText(QString("%1 - Level %2 (EXP: %3/%4)")
+                .arg(player->name).arg(player->level).arg(player->exp).arg(player->level * 100));
+        }
+        
+        if (shownPlayerHP.changed(player->hp, player->maxHp)) {
+            playerHPBar->setMaximum(player->maxHp);
+            playerHPBar->setValue(player->hp);
+            playerHPBar->setFormat(QString("%1/%2").arg(player->hp).arg(player->maxHp));
+        }
+        
+        if (shownPlayerMP.changed(player->mp, player->maxMp)) {
+            playerMPBar->setMaximum(player->maxMp);
+            playerMPBar->setValue(player->mp);
+            playerMPBar->setFormat(QString("%1/%2").arg(player->mp).arg(player->maxMp));
+        }
+        
+        if (shownPlayerStats.changed(player->attack, player->defense, heroStatus.active[0])) {
+            playerStatsLabel->setText(QString("ATK: %1 | DEF: %2")
+                .arg(player->attack).arg(player->defense) + effectList(heroStatus.active[0]));
+        }
+        
+        // Update enemy info; a group shows its combined HP
+        if (inBattle && enemiesLeft > 0) {
+            if (shownEnemyName.changed(true, enemyName, groupLevel, enemiesLeft)) {
+                enemyNameLabel->setText(QString("%1 - Level %2").arg(groupLabel()).arg(groupLevel));
+            }
+            int hp = accumulate(enemies.hp.begin(), enemies.hp.end(), 0);
+            int maxHp = accumulate(enemies.maxHp.begin(), enemies.maxHp.end(), 0);
+            if (shownEnemyHP.changed(hp, maxHp)) {
+                enemyHPBar->setMaximum(maxHp);
+                enemyHPBar->setValue(hp);
+                enemyHPBar->setFormat(QString("%1/%2").arg(hp).arg(maxHp));
+            }
+            uint8_t front = enemyStatus.active[enemyFront];
+            if (shownEnemyStats.changed(enemies.attack[0], enemies.defense[0], front)) {
+                enemyStatsLabel->setText(QString("ATK: %1 | DEF: %2")
+                    .arg(enemies.attack[0]).arg(enemies.defense[0]) + effectList(front));
+            }
+        } else if (shownEnemyName.changed(false, nullptr, 0, 0)) {
             enemyNameLabel->setText("No enemy");
             enemyHPBar->setValue(0);
             enemyHPBar->setFormat("");
             enemyStatsLabel->setText("");
+            shownEnemyHP.reset();
+            shownEnemyStats.reset();
         }
         
         // Update location
-        locationLabel->setText(QString("Location: %1").arg(currentLocation));
+        if (shownLocation.changed(currentLocation)) {
+            locationLabel->setText(QString("Location: %1").arg(worldMap.names[currentLocation]));
+        }
         
-        // Update battle log
-        battleLogText->setPlainText(battleLog.getRecent());
-        battleLogText->verticalScrollBar()->setValue(
-            battleLogText->verticalScrollBar()->maximum());
+        // Append new battle log lines
+        auto fresh = battleLog.since(shownLogLines);
+        if (!fresh.empty()) {
+            if (battleLog.totalPushed() - shownLogLines > fresh.size()) {
+                battleLogText->clear(); // fell more than a full log behind
+            }
+            for (const QString& msg : fresh) {
+                battleLogText->appendPlainText(msg);
+            }
+            shownLogLines = battleLog.totalPushed();
+            battleLogText->verticalScrollBar()->setValue(
+                battleLogText->verticalScrollBar()->maximum());
+        }
         
         // Enable/disable buttons
-        bool canAct = inBattle && player->hp > 0 && currentEnemy && currentEnemy->hp > 0;
-        attackBtn->setEnabled(canAct);
-        defendBtn->setEnabled(canAct);
-        itemBtn->setEnabled(canAct);
-        abilityList->setEnabled(canAct);
-        
-        locationList->setEnabled(!inBattle);
-        backtrackBtn->setEnabled(!inBattle && locationHistory.size() > 1);
+        bool canAct = inBattle && heroTurn && player->hp > 0 && enemiesLeft > 0;
+        bool canBacktrack = !inBattle && locationHistory.size() > 1;
+        bool canLearn = !inBattle && skillPoints() > 0;
+        if (shownButtons.changed(canAct, inBattle, canBacktrack, canLearn)) {
+            attackBtn->setEnabled(canAct);
+            defendBtn->setEnabled(canAct);
+            itemBtn->setEnabled(canAct);
+            abilityList->setEnabled(canAct || canLearn);
+            
+            locationList->setEnabled(!inBattle);
+            backtrackBtn->setEnabled(canBacktrack);
+        }
+        updateAbilityList();
         
         // Check win/lose
         if (player->hp <= 0) {
-            QMessageBox::critical(this, "Game Over", "You have been defeated!");
+            battleTimer->stop(); // no enemy turn while the box is up
+            notify("Game Over", "You have been defeated!", true);
             resetGame();
         }
         
-        if (currentEnemy && currentEnemy->hp <= 0) {
+        if (inBattle && enemiesLeft == 0) {
             endBattle(true);
         }
     }
     
     void updateAbilityList() {
-        abilityList->clear();
-        vector<SkillNode*> skills;
-        abilityTree.getUnlockedSkills(abilityTree.root, skills);
-        
-        for (auto skill : skills) {
-            QString itemText = QString("%1 (MP: %2, DMG/Heal: %3)")
-                .arg(skill->name).arg(skill->mpCost).arg(skill->damage);
-            abilityList->addItem(itemText);
-        }
+        bool canLearn = !inBattle && skillPoints() > 0;
+        if (shownAbilityList.changed(abilityTree.unlockedCount(), canLearn)) abilityModel.refresh(canLearn);
     }
     
+    // One point per level gained; every skill past the root costs one
+    int skillPoints() const {
+        return max(0, player->level - (int)abilityTree.unlockedCount());
+    }
+    
+    // Visited markers only change by travelling, which also moves us, so
+    // the current location is all this list depends on
     void updateLocationList() {
-        locationList->clear();
-        auto connections = worldMap.connections[currentLocation];
-        for (const QString& loc : connections) {
-            QString marker = visitedLocations.count(loc) ? "✓ " : "? ";
-            locationList->addItem(marker + loc);
-        }
+        if (shownLocationList.changed(currentLocation)) locationModel.setLocation(currentLocation);
     }
     
     void updateDataStructuresInfo() {
         QString info = "Data Structures in Use:\n";
         info += "• Graph: World map\n";
-        info += "• HashMap: Locations\n";
+        info += "• Heap: Shortest routes\n";
+        info += "• Trie: Location search\n";
+        info += "• HashMap: Name symbol table\n";
         info += "• Tree: Ability system\n";
         info += "• Stack: Travel history\n";
         info += "• Set: Visited places\n";
         info += "• Map: Inventory\n";
-        info += "• Queue: Battle log\n";
-        info += "• List: Status effects\n";
+        info += "• Ring buffer: Battle log\n";
+        info += "• Bitset: Status effects\n";
         info += "• Priority Queue: Turn order";
         dataStructLabel->setText(info);
     }
     
     void startBattle() {
+        PROFILE_ZONE("startBattle");
         inBattle = true;
         
         int enemyLvl = worldMap.enemyLevel[currentLocation];
-        QStringList enemyNames = {"Goblin", "Wolf", "Skeleton", "Orc", "Dragon"};
-        QString enemyName = enemyNames[rand() % enemyNames.size()];
+        enemyName = ENEMY_NAMES[rng.encounters.below(size(ENEMY_NAMES))];
         
-        int hp = 40 + enemyLvl * 15;
-        int mp = 20 + enemyLvl * 5;
-        int atk = 10 + enemyLvl * 5;
-        int def = 5 + enemyLvl * 2;
+        // Deeper places split their enemy into bigger groups: up to
+        // (level + 1) / 2 units sharing one enemy's HP and attack
+        size_t groupSize = 1 + rng.encounters.below(max(1, (enemyLvl + 1) / 2));
+        groupSize = min(groupSize, MAX_ENEMY_GROUP);
         
-        currentEnemy = new Character(enemyName, hp, mp, atk, def, false);
-        currentEnemy->level = enemyLvl;
+        groupLevel = enemyLvl;
+        enemies.assign(groupSize, enemyGroupStatsForLevel(enemyLvl, (int)groupSize));
+        enemyStatus.assign(groupSize);
+        heroStatus.assign(1);
+        enemiesLeft = (uint32_t)groupSize;
+        enemyFront = 0;
         
         battleLog.addMessage("=================================");
-        battleLog.addMessage(QString("A wild %1 appears!").arg(enemyName));
+        if (groupSize == 1) {
+            battleLog.addMessage(QString("A wild %1 appears!").arg(enemyName));
+        } else {
+            battleLog.addMessage(QString("%1 %2s appear!").arg(groupSize).arg(enemyName));
+        }
         battleLog.addMessage("=================================");
         
+        heroTurn = false;
+        turns.clear();
+        turns.schedule(SIDE_HERO, heroSpeed());
+        for (uint32_t u = 0; u < groupSize; u++) turns.schedule(SIDE_ENEMY, enemies.speed[u], u);
         updateUI();
+        advanceBattle();
+    }
+    
+    int heroSpeed() const {
+        return statusSpeed(heroStatsForLevel(player->level).speed, heroStatus.active[0]);
+    }
+    
+    // " | Regen, Haste" for a stats label, empty with nothing up
+    static QString effectList(uint8_t active) {
+        QString list;
+        for (int e = 0; e < STATUS_COUNT; e++) {
+            if (!hasStatus(active, (StatusEffect)e)) continue;
+            list += list.isEmpty() ? " | " : ", ";
+            list += statusName((StatusEffect)e);
+        }
+        return list;
+    }
+    
+    QString groupLabel() const {
+        return enemiesLeft > 1 ? QString("%1 ×%2").arg(enemyName).arg(enemiesLeft) : QString(enemyName);
+    }
+    
+    // Single-target hit, through the unit's defense like Character::takeDamage
+    void hitEnemy(uint32_t unit, int damage) {
+        enemies.hp[unit] = max(0, enemies.hp[unit] - mitigatedDamage(damage, enemies.defense[unit]));
+    }
+    
+    // Recounts the group after damage and reports who fell
+    void countStanding() {
+        uint32_t before = enemiesLeft;
+        enemiesLeft = (uint32_t)enemies.standing();
+        enemyFront = (uint32_t)enemies.firstStanding(enemyFront);
+        uint32_t fallen = before - enemiesLeft;
+        if (fallen == 0 || enemiesLeft == 0) return;
+        if (fallen == 1) {
+            battleLog.addMessage(QString("A %1 falls! %2 left.").arg(enemyName).arg(enemiesLeft));
+        } else {
+            battleLog.addMessage(QString("%1 %2s fall! %3 left.").arg(fallen).arg(enemyName).arg(enemiesLeft));
+        }
+    }
+    
+    // Takes turns in virtual-time order until the hero is up or the fight
+    // is over. A replay runs enemy turns back to back; the GUI waits out
+    // each enemy's delay on battleTimer first.
+    void advanceBattle() {
+        while (inBattle && !heroTurn && !turns.empty()) {
+            const BattleTurn& next = turns.peek();
+            if (next.side == SIDE_HERO) {
+                turns.next();
+                beginHeroTurn();
+            } else if (enemies.hp[next.unit] <= 0) {
+                turns.next(); // fallen; drops out of the order
+            } else if (replaying) {
+                enemyTurn();
+            } else {
+                battleTimer->start((int)turns.untilNext());
+                return;
+            }
+        }
+    }
+    
+    void beginHeroTurn() {
+        heroTurn = true;
+        dropGuard();
+        tickEffects();
+        updateUI();
+    }
+    
+    // A round of status effects on both sides, at the top of each hero turn
+    void tickEffects() {
+        StatusTick hero = tickStatus(heroStatus, &player->hp, &player->maxHp, 1);
+        StatusTick foes = tickStatus(enemyStatus, enemies.hp.data(), enemies.maxHp.data(), enemies.size());
+        
+        if (hero.poisoned > 0) {
+            battleLog.addMessage(QString("Poison deals %1 damage to you!").arg(hero.poisoned));
+        }
+        if (hero.regenerated > 0) {
+            battleLog.addMessage(QString("Regen restores %1 HP!").arg(hero.regenerated));
+        }
+        for (int e = 0; e < STATUS_COUNT; e++) {
+            if (hasStatus(hero.expired, (StatusEffect)e)) {
+                battleLog.addMessage(QString("%1 wears off.").arg(statusName((StatusEffect)e)));
+            }
+        }
+        if (foes.poisoned > 0) {
+            battleLog.addMessage(QString("Poison deals %1 damage to %2!").arg(foes.poisoned).arg(groupLabel()));
+            countStanding();
+        }
+    }
+    
+    // Every successful battle action ends with this; failed ones (no
+    // potion, not enough MP) leave the turn with the hero
+    void endHeroTurn() {
+        heroTurn = false;
+        if (!inBattle) return;
+        turns.schedule(SIDE_HERO, heroSpeed());
+        advanceBattle();
+    }
+    
+    void dropGuard() {
+        player->defense -= guardBonus;
+        guardBonus = 0;
     }
     
     void endBattle(bool victory) {
         inBattle = false;
+        heroTurn = false;
         battleTimer->stop();
+        turns.clear();
+        dropGuard();
         
         if (victory) {
-            int expGain = currentEnemy->level * 30;
-            int goldGain = currentEnemy->level * 20;
+            int expGain = expReward(groupLevel); // a group shares one enemy's stats
+            int goldGain = groupLevel * 20;
             
             battleLog.addMessage("=================================");
             battleLog.addMessage(QString("Victory! Gained %1 EXP!").arg(expGain));
             battleLog.addMessage("=================================");
             
+            int levelBefore = player->level;
             player->addExp(expGain);
+            if (player->level > levelBefore) {
+                battleLog.addMessage(QString("Level up! You are now level %1 and have a skill point to spend.")
+                    .arg(player->level));
+            }
             
-            if (rand() % 3 == 0) {
-                player->inventory["Potion"]++;
+            if (rng.loot.below(3) == 0) {
+                player->inventory[ITEM_POTION]++;
                 battleLog.addMessage("Found a Potion!");
             }
         }
         
-        delete currentEnemy;
-        currentEnemy = nullptr;
+        enemies.clear();
+        enemyStatus.clear();
+        heroStatus.assign(1);
+        enemiesLeft = 0;
         
         updateUI();
     }
     
+    // Every enemy whose turn falls on the next instant attacks: a roll and
+    // a hit each, one log line for the lot
     void enemyTurn() {
-        if (!currentEnemy || currentEnemy->hp <= 0 || !inBattle) {
-            battleTimer->stop();
-            return;
-        }
+        if (!inBattle || enemiesLeft == 0 || turns.empty()) return;
         
-        int damage = currentEnemy->attack + rand() % 10;
-        player->takeDamage(damage);
+        uint64_t at = turns.peek().at;
+        attackers.clear();
+        while (!turns.empty() && turns.peek().side == SIDE_ENEMY && turns.peek().at == at) {
+            uint32_t unit = turns.next().unit;
+            if (enemies.hp[unit] > 0) attackers.push_back(unit);
+        }
+        if (attackers.empty()) return;
+        
+        int total = 0;
+        for (uint32_t unit : attackers) {
+            int damage = enemies.attack[unit] + rng.combat.below(ENEMY_ATTACK_SPREAD);
+            player->takeDamage(damage, statusDefense(heroStatus.active[0]));
+            total += damage;
+            turns.schedule(SIDE_ENEMY, statusSpeed(enemies.speed[unit], enemyStatus.active[unit]), unit);
+        }
         
-        battleLog.addMessage(QString("%1 attacks for %2 damage!")
-            .arg(currentEnemy->name).arg(damage));
+        if (attackers.size() == 1) {
+            battleLog.addMessage(QString("%1 attacks for %2 damage!").arg(enemyName).arg(total));
+        } else {
+            battleLog.addMessage(QString("%1 %2s attack for %3 damage!")
+                .arg(attackers.size()).arg(enemyName).arg(total));
+        }
         
         updateUI();
-        battleTimer->stop();
     }
     
     void resetGame() {
         player->hp = player->maxHp;
         player->mp = player->maxMp;
-        currentLocation = "Starting Village";
+        currentLocation = worldMap.start;
         
         while (locationHistory.size() > 1) {
             locationHistory.pop();
         }
         
         inBattle = false;
-        if (currentEnemy) {
-            delete currentEnemy;
-            currentEnemy = nullptr;
-        }
+        heroTurn = false;
+        battleTimer->stop();
+        turns.clear();
+        dropGuard();
+        enemies.clear();
+        enemyStatus.clear();
+        heroStatus.assign(1);
+        enemiesLeft = 0;
         
         battleLog.addMessage("Game reset. Starting over...");
         updateUI();
         updateLocationList();
     }
     
+    // Message boxes would stop a replay; there they go to the battle log
+    void notify(const QString& title, const QString& text, bool critical = false) {
+        if (replaying) {
+            battleLog.addMessage(QString("[%1] %2").arg(title).arg(text));
+        } else if (critical) {
+            QMessageBox::critical(this, title, text);
+        } else {
+            QMessageBox::information(this, title, text);
+        }
+    }
+    
+    using CastFn = void (FantasyRPG::*)(const SkillNode&, const char*);
+    
+    template <size_t... K>
+    static constexpr array<CastFn, sizeof...(K)> castTable(index_sequence<K...>) {
+        return {{&FantasyRPG::cast<(SkillKind)K>...}};
+    }
+    
+    // Resolves one kind of ability. SKILL_RULES[K] is known at compile
+    // time, so each instantiation keeps only the branch it needs.
+    template <SkillKind K>
+    void cast(const SkillNode& skill, const char* name) {
+        constexpr SkillRule rule = SKILL_RULES[K];
+        if constexpr (rule.damage && rule.target == TARGET_FRONT) {
+            hitEnemy(enemyFront, skill.power);
+            battleLog.addMessage(QString("Cast %1 for %2 damage!").arg(name).arg(skill.power));
+            countStanding();
+        } else if constexpr (rule.damage && rule.target == TARGET_ALL_ENEMIES) {
+            long long dealt = resolveAreaAttack(skill.power, enemies.defense.data(),
+                                                enemies.hp.data(), enemies.size());
+            battleLog.addMessage(QString("Cast %1 on %2 for %3 damage!")
+                .arg(name).arg(groupLabel()).arg(dealt));
+            countStanding();
+        } else if constexpr (rule.heal) {
+            player->heal(skill.power);
+            battleLog.addMessage(QString("Cast %1! Restored %2 HP!").arg(name).arg(skill.power));
+        } else if constexpr (rule.status != STATUS_COUNT && rule.target == TARGET_ALL_ENEMIES) {
+            enemyStatus.applyAll(rule.status, skill.power);
+            battleLog.addMessage(QString("Cast %1! %2 hit by %3 for %4 rounds!")
+                .arg(name).arg(groupLabel()).arg(statusName(rule.status)).arg(skill.power));
+        } else if constexpr (rule.status != STATUS_COUNT) {
+            heroStatus.apply(0, rule.status, skill.power);
+            battleLog.addMessage(QString("Cast %1! %2 for %3 rounds!")
+                .arg(name).arg(statusName(rule.status)).arg(skill.power));
+        }
+    }
+    
+    void useAbility(uint32_t slot) {
+        PROFILE_ZONE("onUseAbility");
+        if (enemiesLeft == 0 || !inBattle || !heroTurn) return;
+        if (!abilityTree.exists(slot) || !abilityTree.unlocked(slot)) return;
+        recorder.record(CMD_ABILITY, slot);
+        const SkillNode& skill = abilityTree.node(slot);
+        const char* name = abilityTree.name(slot);
+        
+        if (player->mp >= skill.cost) {
+            player->mp -= skill.cost;
+            
+            // One entry per SkillKind, each a cast<> built for that kind
+            static constexpr auto casts = castTable(make_index_sequence<SKILL_KIND_COUNT>());
+            (this->*casts[skill.kind])(skill, name);
+            
+            updateUI();
+            endHeroTurn();
+        } else {
+            notify("Not Enough MP", QString("Need %1 MP to cast %2!").arg(skill.cost).arg(name));
+        }
+    }
+    
+    void travelTo(uint32_t newLocation) {
+        PROFILE_ZONE("onTravel");
+        if (inBattle) return;
+        recorder.record(CMD_TRAVEL, newLocation);
+        
+        locationHistory.push(newLocation);
+        currentLocation = newLocation;
+        visitedLocations[newLocation] = 1;
+        worldMap.recordVisit(newLocation);
+        
+        battleLog.addMessage(QString("Traveled to %1").arg(worldMap.names[newLocation]));
+        battleLog.addMessage(worldMap.locationDesc[newLocation]);
+        
+        updateLocationList();
+        updateUI();
+        
+        // Random encounter
+        if (rng.encounters.chance(60)) {
+            startBattle();
+        }
+    }
+    
 private slots:
     void onAttack() {
-        if (!currentEnemy || !inBattle) return;
+        PROFILE_ZONE("onAttack");
+        if (enemiesLeft == 0 || !inBattle || !heroTurn) return;
+        recorder.record(CMD_ATTACK);
         
-        int damage = player->attack + rand() % 15;
-        currentEnemy->takeDamage(damage);
+        int damage = player->attack + rng.combat.below(PLAYER_ATTACK_SPREAD);
+        hitEnemy(enemyFront, damage);
         
         battleLog.addMessage(QString("You attack for %1 damage!").arg(damage));
+        countStanding();
         updateUI();
-        
-        if (currentEnemy->hp > 0) {
-            battleTimer->start(1500); // Enemy attacks after 1.5 seconds
-        }
+        endHeroTurn();
     }
     
     void onDefend() {
-        if (!currentEnemy || !inBattle) return;
+        PROFILE_ZONE("onDefend");
+        if (enemiesLeft == 0 || !inBattle || !heroTurn) return;
+        recorder.record(CMD_DEFEND);
         
-        int tempDefense = player->defense;
-        player->defense += 10;
+        // Lasts through every enemy turn until the hero moves again
+        guardBonus = 10;
+        player->defense += guardBonus;
         
         battleLog.addMessage("You brace for impact! Defense increased!");
         
-        QTimer::singleShot(100, [this, tempDefense]() {
-            player->defense = tempDefense;
-            battleTimer->start(1500);
-        });
-        
         updateUI();
+        endHeroTurn();
     }
     
     void onUseItem() {
-        if (!inBattle) return;
-        
-        if (player->inventory["Potion"] > 0) {
-            player->inventory["Potion"]--;
-            player->heal(40);
-            battleLog.addMessage("Used Potion! Restored 40 HP!");
+        PROFILE_ZONE("onUseItem");
+        if (!inBattle || !heroTurn) return;
+        recorder.record(CMD_USE_ITEM);
+        
+        if (player->inventory[ITEM_POTION] > 0) {
+            player->inventory[ITEM_POTION]--;
+            player->heal(POTION_HEAL);
+            battleLog.addMessage(QString("Used Potion! Restored %1 HP!").arg(POTION_HEAL));
             updateUI();
-            battleTimer->start(1500);
+            endHeroTurn();
         } else {
-            QMessageBox::information(this, "No Items", "You don't have any potions!");
-        }
-    }
-    
-    void onUseAbility(QListWidgetItem* item) {
-        if (!currentEnemy || !inBattle) return;
-        
-        QString abilityText = item->text();
-        QString abilityName = abilityText.split(" (")[0];
-        
-        vector<SkillNode*> skills;
-        abilityTree.getUnlockedSkills(abilityTree.root, skills);
-        
-        for (auto skill : skills) {
-            if (skill->name == abilityName) {
-                if (player->mp >= skill->mpCost) {
-                    player->mp -= skill->mpCost;
-                    
-                    if (skill->type == "attack") {
-                        currentEnemy->takeDamage(skill->damage);
-                        battleLog.addMessage(QString("Cast %1 for %2 damage!")
-                            .arg(skill->name).arg(skill->damage));
-                    } else if (skill->type == "heal") {
-                        player->heal(skill->damage);
-                        battleLog.addMessage(QString("Cast %1! Restored %2 HP!")
-                            .arg(skill->name).arg(skill->damage));
-                    }
-                    
-                    updateUI();
-                    
-                    if (currentEnemy->hp > 0) {
-                        battleTimer->start(1500);
-                    }
-                } else {
-                    QMessageBox::information(this, "Not Enough MP", 
-                        QString("Need %1 MP to cast %2!").arg(skill->mpCost).arg(skill->name));
-                }
-                break;
-            }
+            notify("No Items", "You don't have any potions!");
         }
     }
     
-    void onTravel(QListWidgetItem* item) {
-        if (inBattle) return;
-        
-        QString locationText = item->text();
-        QString newLocation = locationText.replace("✓ ", "").replace("? ", "");
+    void onUseAbility(const QModelIndex& index) {
+        uint32_t slot = index.data(Qt::UserRole).toUInt();
+        if (abilityTree.exists(slot) && abilityTree.unlocked(slot)) {
+            useAbility(slot);
+        } else {
+            learnAbility(slot);
+        }
+    }
+    
+    // Outside battle only; a skill needs its parent learned first
+    void learnAbility(uint32_t slot) {
+        if (inBattle || skillPoints() <= 0 || !abilityTree.learnable(slot)) return;
+        recorder.record(CMD_UNLOCK, slot);
+        abilityTree.unlock(slot);
+        battleLog.addMessage(QString("Learned %1! %2 skill points left.")
+            .arg(abilityTree.name(slot)).arg(skillPoints()));
+        updateUI();
+    }
+    
+    void onTravel(const QModelIndex& index) {
+        travelTo(index.data(Qt::UserRole).toUInt());
+    }
+    
+    void onBacktrack() {
+        PROFILE_ZONE("onBacktrack");
+        if (locationHistory.size() <= 1 || inBattle) return;
+        recorder.record(CMD_BACKTRACK);
         
-        locationHistory.push(newLocation);
-        currentLocation = newLocation;
-        visitedLocations.insert(newLocation);
+        locationHistory.pop();
+        currentLocation = locationHistory.top();
         
-        battleLog.addMessage(QString("Traveled to %1").arg(newLocation));
-        battleLog.addMessage(worldMap.locationDesc[newLocation]);
+        battleLog.addMessage(QString("Backtracked to %1").arg(worldMap.names[currentLocation]));
         
         updateLocationList();
         updateUI();
+    }
+    
+    // The snapshot is copied here; the file is written on the saver thread
+    void onSave() {
+        if (inBattle) {
+            battleLog.addMessage("You can't save in the middle of a battle!");
+            updateUI();
+            return;
+        }
         
-        // Random encounter
-        if (rand() % 100 < 60) { // 60% chance
-            startBattle();
+        SnapshotWriter out;
+        SavedHero h = {(int32_t)worldMap.names.size(), currentLocation,
+                       player->hp, player->maxHp, player->mp, player->maxMp,
+                       player->level, player->exp, player->attack, player->defense};
+        out.addValue("HERO", h);
+        out.addValue("SEED", rng.seed);
+        uint64_t rngState[12];
+        rng.getState(rngState);
+        out.add("RNGS", rngState, 12);
+        
+        // Symbols are per-process, so items are saved by name
+        vector<string> itemNames;
+        vector<int32_t> itemCounts;
+        for (Symbol item = 0; item < player->inventory.size(); item++) {
+            if (player->inventory.get(item) == 0) continue;
+            itemNames.push_back(symbols().name(item));
+            itemCounts.push_back(player->inventory.get(item));
+        }
+        out.addStrings("INVN", itemNames);
+        out.add("INVC", itemCounts);
+        
+        out.add("VIST", visitedLocations);
+        out.add("VCNT", worldMap.visits);
+        stack<uint32_t> rest = locationHistory;
+        vector<uint32_t> history(rest.size());
+        for (size_t i = history.size(); i-- > 0; rest.pop()) history[i] = rest.top();
+        out.add("HIST", history);
+        out.add("SKIL", abilityTree.unlockBits());
+        
+        saveBtn->setEnabled(false);
+        bool started = saver.save(std::move(out), SAVE_PATH, [this](bool ok) {
+            battleLog.post(ok ? "Game saved." : "Save failed!");
+            QMetaObject::invokeMethod(this, [this]() {
+                saveBtn->setEnabled(true);
+                updateUI();
+            }, Qt::QueuedConnection);
+        });
+        if (!started) {
+            battleLog.addMessage("Still saving, try again in a moment.");
+            saveBtn->setEnabled(true);
+            updateUI();
         }
     }
     
-    void onBacktrack() {
-        if (locationHistory.size() <= 1 || inBattle) return;
+    // Everything is checked before anything is applied
+    void onLoad() {
+        QElapsedTimer timer;
+        timer.start();
+        
+        SnapshotReader in;
+        SavedHero h;
+        uint64_t seed;
+        const uint64_t* rngState;
+        const uint64_t* skills;
+        const uint32_t* history;
+        size_t rngWords, skillWords, historyCount;
+        vector<string> itemNames;
+        vector<int32_t> itemCounts;
+        vector<uint8_t> visited;
+        vector<uint32_t> visits;
+        
+        uint32_t locations = (uint32_t)worldMap.names.size();
+        bool ok = in.open(SAVE_PATH) && in.verify()
+            && in.getValue("HERO", h) && h.locationCount == (int32_t)locations
+            && h.currentLocation < locations
+            && in.getValue("SEED", seed)
+            && in.get("RNGS", rngState, rngWords) && rngWords == 12
+            && in.getStrings("INVN", itemNames) && in.get("INVC", itemCounts)
+            && itemNames.size() == itemCounts.size()
+            && in.get("VIST", visited) && visited.size() == locations
+            && in.get("VCNT", visits) && visits.size() == locations
+            && in.get("HIST", history, historyCount) && historyCount > 0
+            && in.get("SKIL", skills, skillWords) && skillWords == abilityTree.unlockBits().size();
+        for (size_t i = 0; ok && i < historyCount; i++) {
+            ok = history[i] < locations;
+        }
+        if (!ok) {
+            notify("Load", QString("No usable save in %1").arg(SAVE_PATH));
+            return;
+        }
         
-        locationHistory.pop();
-        currentLocation = locationHistory.top();
+        inBattle = false;
+        heroTurn = false;
+        battleTimer->stop();
+        turns.clear();
+        guardBonus = 0; // defense comes from the save
+        enemies.clear();
+        enemyStatus.clear();
+        heroStatus.assign(1);
+        enemiesLeft = 0;
+        
+        player->hp = h.hp;
+        player->maxHp = h.maxHp;
+        player->mp = h.mp;
+        player->maxMp = h.maxMp;
+        player->level = h.level;
+        player->exp = h.exp;
+        player->attack = h.attack;
+        player->defense = h.defense;
+        player->inventory.clear();
+        for (size_t i = 0; i < itemNames.size(); i++) {
+            player->inventory[symbols().intern(itemNames[i])] = itemCounts[i];
+        }
+        
+        currentLocation = h.currentLocation;
+        visitedLocations = visited;
+        worldMap.restoreVisits(visits);
+        locationHistory = stack<uint32_t>();
+        for (size_t i = 0; i < historyCount; i++) locationHistory.push(history[i]);
         
-        battleLog.addMessage(QString("Backtracked to %1").arg(currentLocation));
+        abilityTree.restoreUnlocks(skills, skillWords);
+        rng.seed = seed;
+        rng.setState(rngState);
+        recorder.record(CMD_LOAD);
         
+        battleLog.addMessage(QString("Game loaded in %1 ms.").arg(timer.elapsed()));
+        shownLocationList.reset(); // visited markers may differ at the same location
         updateLocationList();
+        updateAbilityList();
+        updateUI();
+    }
+    
+    void onShowRoute() {
+        showRouteTo(worldMap.goal);
+    }
+    
+    void showRouteTo(uint32_t destination) {
+        Route route = worldMap.route(currentLocation, destination);
+        if (!route.found()) {
+            battleLog.addMessage(QString("No road leads to %1.").arg(worldMap.names[destination]));
+        } else {
+            QString path;
+            for (size_t i = 0; i < route.path.size(); i++) {
+                if (i > 0) path += " → ";
+                path += worldMap.names[route.path[i]];
+            }
+            battleLog.addMessage(QString("Route: %1 (%2 leagues)").arg(path).arg(route.cost));
+        }
         updateUI();
     }
     
+    // Fires on every keystroke in the search box
+    void onSearch(const QString& text) {
+        searchResults->clear();
+        if (text.isEmpty()) return;
+        
+        for (uint32_t id : worldMap.search.topK(text.toStdString(), 5)) {
+            QListWidgetItem* item = new QListWidgetItem(worldMap.names[id]);
+            item->setData(Qt::UserRole, id);
+            searchResults->addItem(item);
+        }
+    }
+    
+    void onSearchPick(QListWidgetItem* item) {
+        showRouteTo(item->data(Qt::UserRole).toUInt());
+    }
+    
     void onShowSkillTree() {
-        QString treeInfo = "Skill Tree (Unlocked abilities marked with ✓):\n\n";
-        treeInfo += buildTreeString(abilityTree.root, 0);
+        QString treeInfo = QString("Skill Tree (Unlocked abilities marked with ✓), %1 skill points:\n\n")
+            .arg(skillPoints());
+        treeInfo += buildTreeString(0, 0);
         
         QMessageBox::information(this, "Ability Tree", treeInfo);
     }
     
-    QString buildTreeString(SkillNode* node, int depth) {
-        if (!node) return "";
+    QString buildTreeString(uint32_t slot, int depth) {
+        if (!abilityTree.exists(slot)) return "";
         
+        const SkillNode& skill = abilityTree.node(slot);
         QString indent = QString("  ").repeated(depth);
-        QString marker = node->unlocked ? "✓" : "✗";
+        QString marker = abilityTree.unlocked(slot) ? "✓" : "✗";
         QString result = QString("%1%2 %3 (MP:%4, DMG:%5)\n")
-            .arg(indent).arg(marker).arg(node->name).arg(node->mpCost).arg(node->damage);
+            .arg(indent).arg(marker).arg(abilityTree.name(slot)).arg(skill.cost).arg(skill.power);
         
-        result += buildTreeString(node->left, depth + 1);
-        result += buildTreeString(node->right, depth + 1);
+        result += buildTreeString(SkillTree::leftChild(slot), depth + 1);
+        result += buildTreeString(SkillTree::rightChild(slot), depth + 1);
         
         return result;
     }
 };
 
 int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
+    // --world FILE loads another map; see world_loader.h for the format.
+    // --record FILE logs every command; --replay FILE runs such a log
+    // headless and prints where it ended.
+    string worldPath = "rpg.world";
+    string recordPath, replayPath;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (string(argv[i]) == "--world") worldPath = argv[i + 1];
+        if (string(argv[i]) == "--record") recordPath = argv[i + 1];
+        if (string(argv[i]) == "--replay") replayPath = argv[i + 1];
+    }
+    
+    if (!replayPath.empty()) {
+        CommandLog log;
+        string error;
+        if (!readCommandLog(replayPath, log, error) || log.game != "rpg") {
+            fprintf(stderr, "%s: %s\n", replayPath.c_str(), error.empty() ? "not an RPG session" : error.c_str());
+            return 1;
+        }
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+        QApplication app(argc, argv);
+        FantasyRPG game(log.seed, log.world, true);
+        fputs(qPrintable(game.replay(log.commands)), stdout);
+        return 0;
+    }
     
-    FantasyRPG game;
+    QApplication app(argc, argv);
+    FantasyRPG game(seedFromArgs(argc, argv), worldPath);
+    if (!recordPath.empty() && !game.startRecording(recordPath)) {
+        fprintf(stderr, "Cannot record to %s\n", recordPath.c_str());
+    }
     game.show();
     
-    return app.exec();
+    int status = app.exec();
+#if defined(ENABLE_PROFILER)
+    // Open in chrome://tracing or ui.perfetto.dev
+    profiler().writeChromeTrace("rpg_trace.json");
+#endif
+    return status;
 }
 
 // Save as: main.cpp
 // Compile with: qmake -project "QT += widgets" && qmake && make
+// Profiling build: add "DEFINES += ENABLE_PROFILER" to the .pro file
 // Or use Qt Creator IDE
\ No newline at end of file
@@ -0,0 +1,170 @@
+// profiler.h
+// Scoped timing zones recorded into per-thread buffers, with per-frame
+// summaries and a Chrome trace dump. Compiled out unless ENABLE_PROFILER.
+#pragma once
+
+// PROFILE_ZONE("name") times the rest of the enclosing scope. The name
+// must be a string literal: zones are grouped by pointer, not by text.
+#if defined(ENABLE_PROFILER)
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) do {} while (0)
+#endif
+
+#if defined(ENABLE_PROFILER)
+
+#include <vector>
+#include <string>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t start;    // ns since the profiler started
+    uint64_t duration; // ns
+};
+
+// Per-zone totals over some time window
+struct ProfileStat {
+    const char* name;
+    uint64_t total; // ns
+    uint64_t longest;
+    uint32_t calls;
+};
+
+// ============ PER-THREAD BUFFER ============
+
+// Ring of the last CAPACITY zones closed on one thread. Only the owning
+// thread writes, with no locks or read-modify-write; others may read up
+// to count(). Entries being overwritten during a cross-thread read can
+// come out torn, so dumps skip the oldest part of each ring.
+class ProfileBuffer {
+public:
+    static constexpr size_t CAPACITY = 1 << 15;
+    
+    explicit ProfileBuffer(uint32_t id) : threadId(id) {}
+    
+    void push(const ProfileEvent& e) {
+        uint64_t n = written.load(std::memory_order_relaxed);
+        events[n & (CAPACITY - 1)] = e;
+        written.store(n + 1, std::memory_order_release);
+    }
+    
+    uint64_t count() const { return written.load(std::memory_order_acquire); }
+    const ProfileEvent& at(uint64_t i) const { return events[i & (CAPACITY - 1)]; }
+    
+    const uint32_t threadId;
+    
+private:
+    std::array<ProfileEvent, CAPACITY> events;
+    std::atomic<uint64_t> written{0};
+};
+
+// ============ PROFILER ============
+
+class Profiler {
+public:
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+    
+    uint64_t now() const {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count();
+    }
+    
+    // The calling thread's buffer; registering it is the only locked step
+    ProfileBuffer& threadBuffer() {
+        thread_local ProfileBuffer* mine = registerThread();
+        return *mine;
+    }
+    
+    // Zones the calling thread started in [from, to), longest total first
+    void summarize(uint64_t from, uint64_t to, std::vector<ProfileStat>& out) {
+        out.clear();
+        ProfileBuffer& buf = threadBuffer();
+        uint64_t n = buf.count();
+        uint64_t first = n > ProfileBuffer::CAPACITY ? n - ProfileBuffer::CAPACITY : 0;
+        for (uint64_t i = n; i-- > first;) {
+            const ProfileEvent& e = buf.at(i);
+            if (e.start + e.duration < from) break; // pushed in close order
+            if (e.start < from || e.start >= to) continue;
+            auto it = std::find_if(out.begin(), out.end(),
+                                   [&](const ProfileStat& s) { return s.name == e.name; });
+            if (it == out.end()) {
+                out.push_back({e.name, 0, 0, 0});
+                it = out.end() - 1;
+            }
+            it->total += e.duration;
+            it->longest = std::max(it->longest, e.duration);
+            it->calls++;
+        }
+        std::sort(out.begin(), out.end(),
+                  [](const ProfileStat& a, const ProfileStat& b) { return a.total > b.total; });
+    }
+    
+    // Every thread's recent zones in Chrome's trace event format; open the
+    // file in chrome://tracing or ui.perfetto.dev
+    bool writeChromeTrace(const std::string& path) {
+        FILE* f = fopen(path.c_str(), "w");
+        if (!f) return false;
+        fputs("{\"traceEvents\":[\n", f);
+        bool firstEvent = true;
+        std::lock_guard<std::mutex> lock(registryLock);
+        for (auto& buf : buffers) {
+            uint64_t n = buf->count();
+            uint64_t keep = ProfileBuffer::CAPACITY - ProfileBuffer::CAPACITY / 4;
+            for (uint64_t i = n > keep ? n - keep : 0; i < n; i++) {
+                const ProfileEvent& e = buf->at(i);
+                fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                        firstEvent ? "" : ",\n", e.name, buf->threadId, e.start / 1000.0, e.duration / 1000.0);
+                firstEvent = false;
+            }
+        }
+        fputs("\n]}\n", f);
+        return fclose(f) == 0;
+    }
+    
+private:
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    std::mutex registryLock; // guards buffers, never held while recording
+    std::vector<std::unique_ptr<ProfileBuffer>> buffers; // kept after their thread exits
+    
+    ProfileBuffer* registerThread() {
+        std::lock_guard<std::mutex> lock(registryLock);
+        buffers.emplace_back(new ProfileBuffer((uint32_t)buffers.size()));
+        return buffers.back().get();
+    }
+};
+
+inline Profiler& profiler() { return Profiler::instance(); }
+
+// ============ SCOPED ZONE ============
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* zoneName) : name(zoneName), start(profiler().now()) {}
+    ~ProfileZone() {
+        Profiler& p = profiler();
+        p.threadBuffer().push({name, start, p.now() - start});
+    }
+    
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+    
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#endif
@@ -0,0 +1,118 @@
+// render_batch.h
+// Batched SFML drawing: one draw call per layer instead of one per shape
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <string>
+
+// ============ GLYPH BATCH ============
+
+// Text laid out as textured quads from the font's glyph page, so any
+// number of labels at one character size costs a single draw call
+class GlyphBatch {
+public:
+    GlyphBatch(const sf::Font& f, unsigned characterSize)
+        : font(&f), size(characterSize), quads(sf::Quads) {}
+    
+    void clear() { quads.clear(); }
+    size_t vertexCount() const { return quads.getVertexCount(); }
+    
+    // Same placement as sf::Text at (x, y); returns the advance width
+    float addText(const std::string& str, float x, float y, sf::Color color = sf::Color::White) {
+        float penX = x;
+        float baseline = y + size;
+        sf::Uint32 prev = 0;
+        for (unsigned char ch : str) {
+            sf::Uint32 c = ch;
+            penX += font->getKerning(prev, c, size);
+            prev = c;
+            
+            const sf::Glyph& glyph = font->getGlyph(c, size, false);
+            float left = penX + glyph.bounds.left;
+            float top = baseline + glyph.bounds.top;
+            float right = left + glyph.bounds.width;
+            float bottom = top + glyph.bounds.height;
+            
+            float u1 = (float)glyph.textureRect.left;
+            float v1 = (float)glyph.textureRect.top;
+            float u2 = u1 + glyph.textureRect.width;
+            float v2 = v1 + glyph.textureRect.height;
+            
+            quads.append(sf::Vertex(sf::Vector2f(left, top), color, sf::Vector2f(u1, v1)));
+            quads.append(sf::Vertex(sf::Vector2f(right, top), color, sf::Vector2f(u2, v1)));
+            quads.append(sf::Vertex(sf::Vector2f(right, bottom), color, sf::Vector2f(u2, v2)));
+            quads.append(sf::Vertex(sf::Vector2f(left, bottom), color, sf::Vector2f(u1, v2)));
+            
+            penX += glyph.advance;
+        }
+        return penX - x;
+    }
+    
+    void draw(sf::RenderTarget& target) const {
+        sf::RenderStates states(&font->getTexture(size));
+        target.draw(quads, states);
+    }
+    
+private:
+    const sf::Font* font;
+    unsigned size;
+    sf::VertexArray quads;
+};
+
+// ============ CIRCLE ATLAS ============
+
+// A white disc and a white ring rendered once into a small texture.
+// Circles then become tinted quads that batch into one vertex array.
+class CircleAtlas {
+public:
+    static const int CELL = 64;
+    
+    // innerRatio is the ring's inner radius as a fraction of its outer one
+    bool create(float innerRatio) {
+        if (!canvas.create(CELL * 2, CELL)) return false;
+        canvas.setSmooth(true);
+        canvas.clear(sf::Color::Transparent);
+        
+        float r = CELL / 2.0f;
+        sf::CircleShape disc(r, 64);
+        disc.setFillColor(sf::Color::White);
+        canvas.draw(disc);
+        
+        float inner = r * innerRatio;
+        sf::CircleShape ring(inner, 64);
+        ring.setFillColor(sf::Color::Transparent);
+        ring.setOutlineThickness(r - inner);
+        ring.setOutlineColor(sf::Color::White);
+        ring.setPosition(CELL + r - inner, r - inner);
+        canvas.draw(ring);
+        
+        canvas.display();
+        return true;
+    }
+    
+    const sf::Texture& texture() const { return canvas.getTexture(); }
+    
+    // Appends 4 vertices
+    void addDisc(sf::VertexArray& quads, sf::Vector2f center, float radius, sf::Color color) const {
+        addQuad(quads, center, radius, color, 0);
+    }
+    
+    void addRing(sf::VertexArray& quads, sf::Vector2f center, float outerRadius, sf::Color color) const {
+        addQuad(quads, center, outerRadius, color, CELL);
+    }
+    
+    // Recolors the quad whose first vertex is at index first
+    static void setColor(sf::VertexArray& quads, size_t first, sf::Color color) {
+        for (size_t i = first; i < first + 4; i++) quads[i].color = color;
+    }
+    
+private:
+    sf::RenderTexture canvas;
+    
+    static void addQuad(sf::VertexArray& quads, sf::Vector2f c, float r, sf::Color color, float u) {
+        quads.append(sf::Vertex(sf::Vector2f(c.x - r, c.y - r), color, sf::Vector2f(u, 0)));
+        quads.append(sf::Vertex(sf::Vector2f(c.x + r, c.y - r), color, sf::Vector2f(u + CELL, 0)));
+        quads.append(sf::Vertex(sf::Vector2f(c.x + r, c.y + r), color, sf::Vector2f(u + CELL, CELL)));
+        quads.append(sf::Vertex(sf::Vector2f(c.x - r, c.y + r), color, sf::Vector2f(u, CELL)));
+    }
+};
@@ -0,0 +1,117 @@
+// ring_buffer.h
+// Fixed-capacity ring buffers for the battle log and the dungeon event log
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// ============ RING BUFFER ============
+
+// Keeps the last N entries. push() is O(1) and overwrites the oldest entry
+// once full; nothing is ever shifted or copied on read.
+template <class T, size_t N>
+class RingBuffer {
+public:
+    // Read-only window over `count` consecutive entries, oldest first
+    class View {
+    public:
+        class iterator {
+        public:
+            iterator(const RingBuffer* r, size_t i) : ring(r), index(i) {}
+            const T& operator*() const { return ring->cells[index % N]; }
+            const T* operator->() const { return &ring->cells[index % N]; }
+            iterator& operator++() { index++; return *this; }
+            bool operator!=(const iterator& o) const { return index != o.index; }
+            bool operator==(const iterator& o) const { return index == o.index; }
+        private:
+            const RingBuffer* ring;
+            size_t index;
+        };
+        
+        View(const RingBuffer* r, size_t first, size_t n) : ring(r), start(first), count(n) {}
+        iterator begin() const { return iterator(ring, start); }
+        iterator end() const { return iterator(ring, start + count); }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        const T& operator[](size_t i) const { return ring->cells[(start + i) % N]; }
+    private:
+        const RingBuffer* ring;
+        size_t start;
+        size_t count;
+    };
+    
+    void push(T value) {
+        cells[(first + count) % N] = std::move(value);
+        if (count < N) {
+            count++;
+        } else {
+            first = (first + 1) % N;
+        }
+        pushed++;
+    }
+    
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    static constexpr size_t capacity() { return N; }
+    
+    // Entries ever pushed, including overwritten ones
+    uint64_t totalPushed() const { return pushed; }
+    
+    // The last n entries (or fewer), oldest first
+    View recent(size_t n) const {
+        if (n > count) n = count;
+        return View(this, first + count - n, n);
+    }
+    
+    View all() const { return View(this, first, count); }
+    typename View::iterator begin() const { return all().begin(); }
+    typename View::iterator end() const { return all().end(); }
+    
+    void clear() {
+        first = 0;
+        count = 0;
+    }
+    
+private:
+    std::array<T, N> cells;
+    size_t first = 0; // index of the oldest entry
+    size_t count = 0;
+    uint64_t pushed = 0;
+};
+
+// ============ SPSC QUEUE ============
+
+// Lock-free single-producer/single-consumer queue. One thread calls
+// tryPush, one other thread calls tryPop; neither ever blocks.
+template <class T, size_t N>
+class SpscQueue {
+public:
+    bool tryPush(T value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t next = (t + 1) % (N + 1);
+        if (next == head.load(std::memory_order_acquire)) return false; // full
+        cells[t] = std::move(value);
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+    
+    bool tryPop(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false; // empty
+        out = std::move(cells[h]);
+        head.store((h + 1) % (N + 1), std::memory_order_release);
+        return true;
+    }
+    
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+    
+private:
+    std::array<T, N + 1> cells; // one spare slot tells full from empty
+    alignas(64) std::atomic<size_t> head{0}; // consumer side
+    alignas(64) std::atomic<size_t> tail{0}; // producer side
+};
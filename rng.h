@@ -0,0 +1,97 @@
+// rng.h
+// Seedable xoshiro256++ generator with a separately seeded stream per subsystem
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+
+// splitmix64, used to expand a 64-bit seed into generator state
+inline uint64_t splitMix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256++ (Blackman & Vigna). No locks, no global state.
+class Rng {
+public:
+    explicit Rng(uint64_t seed = 0, uint64_t stream = 0) { reseed(seed, stream); }
+    
+    // Different (seed, stream) pairs give unrelated sequences: the stream
+    // is hashed into the seed before splitmix64 expands it
+    void reseed(uint64_t seed, uint64_t stream = 0) {
+        uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ull);
+        for (int i = 0; i < 4; i++) s[i] = splitMix64(x);
+    }
+    
+    uint64_t next() {
+        uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+    
+    // Uniform in [0, n) by multiply-shift, no division
+    uint32_t below(uint32_t n) {
+        return (uint32_t)(((next() >> 32) * (uint64_t)n) >> 32);
+    }
+    
+    // True with the given percent chance
+    bool chance(int percent) { return (int)below(100) < percent; }
+    
+    // Raw generator state, for save files
+    void getState(uint64_t out[4]) const { memcpy(out, s, sizeof(s)); }
+    void setState(const uint64_t in[4]) { memcpy(s, in, sizeof(s)); }
+    
+private:
+    uint64_t s[4];
+    
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+// One stream per subsystem, so e.g. extra combat rolls never shift which
+// loot drops or which encounters happen later in the run
+enum RngStream { COMBAT_STREAM = 1, LOOT_STREAM = 2, ENCOUNTER_STREAM = 3 };
+
+class RngService {
+public:
+    uint64_t seed;
+    Rng combat;
+    Rng loot;
+    Rng encounters;
+    
+    explicit RngService(uint64_t s)
+        : seed(s), combat(s, COMBAT_STREAM), loot(s, LOOT_STREAM),
+          encounters(s, ENCOUNTER_STREAM) {}
+    
+    // All three streams back to back, 12 words
+    void getState(uint64_t out[12]) const {
+        combat.getState(out);
+        loot.getState(out + 4);
+        encounters.getState(out + 8);
+    }
+    
+    void setState(const uint64_t in[12]) {
+        combat.setState(in);
+        loot.setState(in + 4);
+        encounters.setState(in + 8);
+    }
+};
+
+// --seed N on the command line, otherwise a fresh seed from the clock
+inline uint64_t seedFromArgs(int argc, char* argv[]) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0) return strtoull(argv[i + 1], nullptr, 10);
+    }
+    uint64_t t = (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    return t ^ ((uint64_t)std::random_device()() << 32);
+}
@@ -0,0 +1,199 @@
+// routing.h
+// Weighted shortest paths over a CsrGraph: Dijkstra and A*
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "graph_core.h"
+
+struct Route {
+    std::vector<uint32_t> path; // source .. target, empty if unreachable
+    float cost = 0.0f;
+    
+    bool found() const { return !path.empty(); }
+};
+
+// 4-ary min-heap of node ids with decrease-key. Keys live in the
+// scratch arrays, so the heap itself is just ids plus their positions.
+class QuadHeap {
+public:
+    std::vector<uint32_t> nodes;
+    std::vector<uint32_t> slot; // slot[node] = index in nodes
+    const float* key = nullptr;
+    
+    bool empty() const { return nodes.empty(); }
+    void clear() { nodes.clear(); }
+    
+    void push(uint32_t u) {
+        nodes.push_back(u);
+        siftUp(nodes.size() - 1);
+    }
+    
+    void decrease(uint32_t u) { siftUp(slot[u]); }
+    
+    uint32_t pop() {
+        uint32_t top = nodes[0];
+        nodes[0] = nodes.back();
+        nodes.pop_back();
+        if (!nodes.empty()) {
+            slot[nodes[0]] = 0;
+            siftDown(0);
+        }
+        return top;
+    }
+    
+private:
+    void siftUp(size_t i) {
+        uint32_t u = nodes[i];
+        float k = key[u];
+        while (i > 0) {
+            size_t parent = (i - 1) / 4;
+            if (key[nodes[parent]] <= k) break;
+            nodes[i] = nodes[parent];
+            slot[nodes[i]] = (uint32_t)i;
+            i = parent;
+        }
+        nodes[i] = u;
+        slot[u] = (uint32_t)i;
+    }
+    
+    void siftDown(size_t i) {
+        uint32_t u = nodes[i];
+        float k = key[u];
+        size_t n = nodes.size();
+        while (true) {
+            size_t first = i * 4 + 1;
+            if (first >= n) break;
+            size_t last = std::min(first + 4, n);
+            size_t best = first;
+            for (size_t c = first + 1; c < last; c++) {
+                if (key[nodes[c]] < key[nodes[best]]) best = c;
+            }
+            if (key[nodes[best]] >= k) break;
+            nodes[i] = nodes[best];
+            slot[nodes[i]] = (uint32_t)i;
+            i = best;
+        }
+        nodes[i] = u;
+        slot[u] = (uint32_t)i;
+    }
+};
+
+// Per-thread search state, reused across queries. Arrays are only grown,
+// never cleared: an entry is valid when its stamp matches the query epoch.
+struct RouteScratch {
+    std::vector<float> dist;     // best known cost from the source
+    std::vector<float> priority; // dist + heuristic, the heap key
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> stamp;
+    std::vector<uint8_t> closed;
+    QuadHeap heap;
+    uint32_t epoch = 0;
+    
+    void prepare(uint32_t nodeCount) {
+        if (stamp.size() < nodeCount) {
+            dist.resize(nodeCount);
+            priority.resize(nodeCount);
+            parent.resize(nodeCount);
+            stamp.resize(nodeCount, 0);
+            closed.resize(nodeCount);
+            heap.slot.resize(nodeCount);
+        }
+        if (++epoch == 0) { // wrapped: invalidate everything once
+            std::fill(stamp.begin(), stamp.end(), 0);
+            epoch = 1;
+        }
+        heap.clear();
+        heap.key = priority.data();
+    }
+    
+    bool seen(uint32_t u) const { return stamp[u] == epoch; }
+    
+    static RouteScratch& local() {
+        static thread_local RouteScratch scratch;
+        return scratch;
+    }
+};
+
+// Best-first search from source to target. With a zero heuristic this is
+// Dijkstra; with an admissible one (never overestimates) it is A*.
+template <class Heuristic>
+Route findRoute(const CsrGraph& g, uint32_t source, uint32_t target, Heuristic h) {
+    Route route;
+    uint32_t n = g.nodeCount();
+    if (source >= n || target >= n) return route;
+    
+    RouteScratch& s = RouteScratch::local();
+    s.prepare(n);
+    
+    s.stamp[source] = s.epoch;
+    s.dist[source] = 0.0f;
+    s.priority[source] = h(source);
+    s.parent[source] = source;
+    s.closed[source] = false;
+    s.heap.push(source);
+    
+    while (!s.heap.empty()) {
+        uint32_t u = s.heap.pop();
+        if (u == target) break;
+        s.closed[u] = true;
+        
+        for (uint32_t i = g.offsets[u]; i < g.offsets[u + 1]; i++) {
+            uint32_t v = g.neighbors[i];
+            float d = s.dist[u] + g.weights[i];
+            if (!s.seen(v)) {
+                s.stamp[v] = s.epoch;
+                s.dist[v] = d;
+                s.priority[v] = d + h(v);
+                s.parent[v] = u;
+                s.closed[v] = false;
+                s.heap.push(v);
+            } else if (!s.closed[v] && d < s.dist[v]) {
+                s.priority[v] -= s.dist[v] - d;
+                s.dist[v] = d;
+                s.parent[v] = u;
+                s.heap.decrease(v);
+            }
+        }
+    }
+    
+    if (!s.seen(target)) return route;
+    
+    route.cost = s.dist[target];
+    for (uint32_t u = target; u != source; u = s.parent[u]) {
+        route.path.push_back(u);
+    }
+    route.path.push_back(source);
+    std::reverse(route.path.begin(), route.path.end());
+    return route;
+}
+
+inline Route dijkstra(const CsrGraph& g, uint32_t source, uint32_t target) {
+    return findRoute(g, source, target, [](uint32_t) { return 0.0f; });
+}
+
+// A* with straight-line distance to the target. Admissible as long as every
+// edge is at least as long as the distance between its endpoints.
+inline Route aStar(const CsrGraph& g, const std::vector<std::pair<int, int>>& positions,
+                   uint32_t source, uint32_t target) {
+    if (target >= positions.size()) return Route();
+    float tx = (float)positions[target].first;
+    float ty = (float)positions[target].second;
+    return findRoute(g, source, target, [&](uint32_t u) {
+        float dx = (float)positions[u].first - tx;
+        float dy = (float)positions[u].second - ty;
+        return std::sqrt(dx * dx + dy * dy);
+    });
+}
+
+// Euclidean length between two positions, the edge weight A* expects
+inline float straightLine(std::pair<int, int> a, std::pair<int, int> b) {
+    double dx = (double)a.first - b.first; // int difference can overflow
+    double dy = (double)a.second - b.second;
+    return (float)std::sqrt(dx * dx + dy * dy);
+}
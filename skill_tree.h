@@ -0,0 +1,231 @@
+// skill_tree.h
+// Flat binary skill tree loaded from a data file, shared by both games
+#pragma once
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+
+// ============ SKILL TREE ============
+
+enum SkillKind : uint8_t {
+    SKILL_PASSIVE, SKILL_ATTACK, SKILL_HEAL, SKILL_AREA,
+    SKILL_REGEN, SKILL_HASTE, SKILL_SHIELD, SKILL_POISON, // status effects, see combat.h
+    SKILL_KIND_COUNT
+};
+
+// Indexed by SkillKind; the names used in the data files
+constexpr const char* SKILL_KIND_NAMES[SKILL_KIND_COUNT] = {
+    "passive", "attack", "heal", "area", "regen", "haste", "shield", "poison"
+};
+
+// One node as compiled-in data, for the built-in trees
+struct SkillDef {
+    uint32_t slot;
+    const char* name;
+    int cost;
+    int power;
+    SkillKind kind;
+};
+
+struct SkillNode {
+    uint32_t nameOffset; // into the name arena
+    int cost;            // gold in the dungeon game, MP in the RPG
+    int power;           // damage, heal amount, or rounds for a status effect
+    SkillKind kind;
+    bool present;        // implicit slots can be empty
+};
+
+// Binary tree in implicit-index form: the children of slot i are slots
+// 2i+1 and 2i+2, so there are no child pointers at all. Nodes live in one
+// array and names in one char arena, so tearing a tree down is two frees.
+// Unlock state is a bitmask, so enumerating unlocked skills walks words.
+//
+// Data file format, one node per line, '#' starts a comment:
+//     slot|name|cost|power|kind
+// kind: passive, attack, heal, area, or a status effect: regen, haste,
+// shield, poison ("buff" is the old name for regen).
+// Slot 0 is the root and starts unlocked.
+class SkillTree {
+public:
+    static constexpr uint32_t MAX_SLOTS = 1u << 20;
+    
+    static uint32_t leftChild(uint32_t i) { return 2 * i + 1; }
+    static uint32_t rightChild(uint32_t i) { return 2 * i + 2; }
+    static uint32_t parentOf(uint32_t i) { return (i - 1) / 2; }
+    
+    static int depthOf(uint32_t i) {
+        int d = 0;
+        for (uint32_t n = i + 1; n > 1; n >>= 1) d++;
+        return d;
+    }
+    
+    uint32_t slotCount() const { return (uint32_t)nodes.size(); }
+    bool exists(uint32_t i) const { return i < nodes.size() && nodes[i].present; }
+    const SkillNode& node(uint32_t i) const { return nodes[i]; }
+    const char* name(uint32_t i) const { return names.data() + nodes[i].nameOffset; }
+    
+    bool unlocked(uint32_t i) const { return (bits[i >> 6] >> (i & 63)) & 1; }
+    
+    size_t unlockedCount() const {
+        size_t n = 0;
+        for (uint64_t word : bits) {
+            for (; word; word &= word - 1) n++;
+        }
+        return n;
+    }
+    
+    // Locked, but its parent is unlocked: the next step down the tree
+    bool learnable(uint32_t i) const {
+        return exists(i) && !unlocked(i) && i > 0 && unlocked(parentOf(i));
+    }
+    
+    // Spends the node's cost out of budget; false if locked out or too poor
+    bool unlock(uint32_t i, int& budget) {
+        if (!exists(i) || unlocked(i) || budget < nodes[i].cost) return false;
+        budget -= nodes[i].cost;
+        return unlock(i);
+    }
+    
+    // No price here; for callers that keep their own budget
+    bool unlock(uint32_t i) {
+        if (!exists(i) || unlocked(i)) return false;
+        bits[i >> 6] |= 1ull << (i & 63);
+        return true;
+    }
+    
+    // Unlock bitmask, one bit per slot, for save files
+    const std::vector<uint64_t>& unlockBits() const { return bits; }
+    
+    // False if the mask was saved from a tree of a different size
+    bool restoreUnlocks(const uint64_t* words, size_t count) {
+        if (count != bits.size()) return false;
+        bits.assign(words, words + count);
+        return true;
+    }
+    
+    // Calls fn(slot) for every unlocked skill in slot order
+    template <class Fn>
+    void forEachUnlocked(Fn fn) const {
+        for (size_t w = 0; w < bits.size(); w++) {
+            for (uint64_t word = bits[w]; word; word &= word - 1) {
+                fn((uint32_t)(w * 64 + lowestBit(word)));
+            }
+        }
+    }
+    
+    // Replaces the tree; false (and an empty tree) on malformed input
+    bool parse(const std::string& text) {
+        clear();
+        std::istringstream in(text);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+            
+            std::vector<std::string> field;
+            std::istringstream columns(line);
+            std::string f;
+            while (std::getline(columns, f, '|')) field.push_back(f);
+            if (field.size() != 5) {
+                clear();
+                return false;
+            }
+            
+            SkillKind kind;
+            char* end = nullptr;
+            unsigned long slot = strtoul(field[0].c_str(), &end, 10);
+            if (*end || field[0].empty() || slot >= MAX_SLOTS || !kindFromString(field[4], kind)) {
+                clear();
+                return false;
+            }
+            add((uint32_t)slot, field[1].data(), field[1].size(), atoi(field[2].c_str()),
+                atoi(field[3].c_str()), kind);
+        }
+        return finish();
+    }
+    
+    // Replaces the tree with a compiled-in one; nothing to parse
+    bool assign(const SkillDef* defs, size_t count) {
+        clear();
+        for (size_t i = 0; i < count; i++) {
+            if (defs[i].slot >= MAX_SLOTS || defs[i].kind >= SKILL_KIND_COUNT) {
+                clear();
+                return false;
+            }
+            add(defs[i].slot, defs[i].name, strlen(defs[i].name), defs[i].cost, defs[i].power, defs[i].kind);
+        }
+        return finish();
+    }
+    
+    template <size_t N>
+    bool assign(const SkillDef (&defs)[N]) { return assign(defs, N); }
+    
+    bool loadFromFile(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) return false;
+        std::stringstream text;
+        text << file.rdbuf();
+        return parse(text.str());
+    }
+    
+    void clear() {
+        nodes.clear();
+        names.clear();
+        bits.clear();
+    }
+    
+private:
+    std::vector<SkillNode> nodes; // indexed by slot
+    std::vector<char> names;      // NUL-terminated names back to back
+    std::vector<uint64_t> bits;   // unlocked flags, one bit per slot
+    
+    void add(uint32_t slot, const char* name, size_t length, int cost, int power, SkillKind kind) {
+        if (slot >= nodes.size()) {
+            nodes.resize(slot + 1, SkillNode{0, 0, 0, SKILL_PASSIVE, false});
+            bits.resize((nodes.size() + 63) / 64, 0);
+        }
+        nodes[slot] = {(uint32_t)names.size(), cost, power, kind, true};
+        names.insert(names.end(), name, name + length);
+        names.push_back('\0');
+    }
+    
+    // Slot 0 must exist; it starts unlocked
+    bool finish() {
+        if (!exists(0)) {
+            clear();
+            return false;
+        }
+        bits[0] |= 1;
+        return true;
+    }
+    
+    static bool kindFromString(const std::string& s, SkillKind& kind) {
+        if (s == "buff") {
+            kind = SKILL_REGEN;
+            return true;
+        }
+        for (int k = 0; k < SKILL_KIND_COUNT; k++) {
+            if (s == SKILL_KIND_NAMES[k]) {
+                kind = (SkillKind)k;
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    static int lowestBit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(word);
+#else
+        int b = 0;
+        while (!(word & 1)) { word >>= 1; b++; }
+        return b;
+#endif
+    }
+};
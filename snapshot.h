@@ -0,0 +1,331 @@
+// snapshot.h
+// Versioned flat binary save files: plain arrays on the way out, one
+// mmap and pointers into it on the way back in
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include "profiler.h"
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// ============ FILE LAYOUT ============
+//
+//   SnapshotHeader
+//   SnapshotSection[sectionCount]
+//   section payloads, each 8-byte aligned
+//
+// Everything is fixed-size and little-endian as written by the host, so
+// reading is bounds checks plus pointer arithmetic; nothing is parsed.
+
+const uint32_t SNAPSHOT_VERSION = 1;
+const char SNAPSHOT_MAGIC[8] = {'C', 'S', '2', '1', '0', 'S', 'A', 'V'};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t fileSize;
+    uint64_t tableChecksum; // over the section table
+};
+
+struct SnapshotSection {
+    uint32_t tag;      // four-character code, see snapshotTag
+    uint32_t elemSize; // sizeof one element, checked on read
+    uint64_t offset;   // from the start of the file
+    uint64_t count;    // number of elements
+    uint64_t checksum; // over the payload bytes
+};
+
+inline uint32_t snapshotTag(const char* code) {
+    return (uint32_t)(uint8_t)code[0] | (uint32_t)(uint8_t)code[1] << 8
+         | (uint32_t)(uint8_t)code[2] << 16 | (uint32_t)(uint8_t)code[3] << 24;
+}
+
+// 64-bit multiply-xor hash, eight bytes per step
+inline uint64_t snapshotChecksum(const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    for (; i < size; i++) {
+        h = (h ^ p[i]) * 0xC4CEB9FE1A85EC53ull;
+    }
+    return h ^ (h >> 29);
+}
+
+// ============ WRITER ============
+
+// Collects sections in memory. Building one is a memcpy of the game's
+// arrays; the file write can then happen anywhere, e.g. BackgroundSaver.
+class SnapshotWriter {
+public:
+    template <class T>
+    void add(const char* tag, const T* data, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot sections must be plain data");
+        SnapshotSection s;
+        s.tag = snapshotTag(tag);
+        s.elemSize = (uint32_t)sizeof(T);
+        s.offset = payload.size(); // relative until writeFile
+        s.count = count;
+        s.checksum = snapshotChecksum(data, count * sizeof(T));
+        sections.push_back(s);
+        
+        const char* bytes = (const char*)data;
+        payload.insert(payload.end(), bytes, bytes + count * sizeof(T));
+        payload.resize((payload.size() + 7) & ~(size_t)7, 0);
+    }
+    
+    template <class T>
+    void add(const char* tag, const std::vector<T>& values) {
+        add(tag, values.data(), values.size());
+    }
+    
+    template <class T>
+    void addValue(const char* tag, const T& value) { add(tag, &value, 1); }
+    
+    // NUL-terminated, back to back
+    void addStrings(const char* tag, const std::vector<std::string>& strings) {
+        std::vector<char> joined;
+        for (auto& s : strings) {
+            joined.insert(joined.end(), s.begin(), s.end());
+            joined.push_back('\0');
+        }
+        add(tag, joined);
+    }
+    
+    // Writes to path + ".tmp" and renames over path, so a crash mid-write
+    // never leaves a torn snapshot behind
+    bool writeFile(const std::string& path) const {
+        SnapshotHeader header;
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.sectionCount = (uint32_t)sections.size();
+        
+        uint64_t base = sizeof(SnapshotHeader) + sections.size() * sizeof(SnapshotSection);
+        std::vector<SnapshotSection> table(sections);
+        for (auto& s : table) s.offset += base;
+        header.fileSize = base + payload.size();
+        header.tableChecksum = snapshotChecksum(table.data(), table.size() * sizeof(SnapshotSection));
+        
+        std::string tmp = path + ".tmp";
+        FILE* f = fopen(tmp.c_str(), "wb");
+        if (!f) return false;
+        bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+            && (table.empty() || fwrite(table.data(), sizeof(SnapshotSection), table.size(), f) == table.size())
+            && (payload.empty() || fwrite(payload.data(), 1, payload.size(), f) == payload.size());
+        ok = fclose(f) == 0 && ok;
+#if defined(_WIN32)
+        if (ok) remove(path.c_str()); // rename does not replace on Windows
+#endif
+        if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+            remove(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+    
+private:
+    std::vector<SnapshotSection> sections;
+    std::vector<char> payload;
+};
+
+// ============ READER ============
+
+// Maps a snapshot read-only. open() checks the header and that every
+// section lies inside the file; verify() additionally hashes payloads.
+// Section data is returned as pointers into the mapping, valid until close.
+class SnapshotReader {
+public:
+    SnapshotReader() {}
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+    ~SnapshotReader() { close(); }
+    
+    bool open(const std::string& path) {
+        close();
+        if (!mapFile(path)) return false;
+        if (!validate()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+    
+    bool verify() const {
+        for (uint32_t i = 0; i < header()->sectionCount; i++) {
+            const SnapshotSection& s = table()[i];
+            if (snapshotChecksum(base + s.offset, s.count * s.elemSize) != s.checksum) return false;
+        }
+        return true;
+    }
+    
+    // Fails if the tag is missing or was written with a different type
+    template <class T>
+    bool get(const char* tag, const T*& data, size_t& count) const {
+        const SnapshotSection* s = find(tag);
+        if (!s || s->elemSize != sizeof(T)) return false;
+        data = (const T*)(base + s->offset);
+        count = (size_t)s->count;
+        return true;
+    }
+    
+    template <class T>
+    bool get(const char* tag, std::vector<T>& out) const {
+        const T* data;
+        size_t count;
+        if (!get(tag, data, count)) return false;
+        out.assign(data, data + count);
+        return true;
+    }
+    
+    template <class T>
+    bool getValue(const char* tag, T& out) const {
+        const T* data;
+        size_t count;
+        if (!get(tag, data, count) || count != 1) return false;
+        out = *data;
+        return true;
+    }
+    
+    bool getStrings(const char* tag, std::vector<std::string>& out) const {
+        const char* data;
+        size_t count;
+        if (!get(tag, data, count) || (count > 0 && data[count - 1] != '\0')) return false;
+        out.clear();
+        for (size_t i = 0; i < count; i += out.back().size() + 1) {
+            out.push_back(std::string(data + i));
+        }
+        return true;
+    }
+    
+    void close() {
+#if defined(_WIN32)
+        buffer.clear();
+#else
+        if (base) munmap((void*)base, size);
+#endif
+        base = nullptr;
+        size = 0;
+    }
+    
+private:
+    const char* base = nullptr;
+    size_t size = 0;
+#if defined(_WIN32)
+    std::vector<uint64_t> buffer; // no mmap here; read into aligned memory
+#endif
+    
+    const SnapshotHeader* header() const { return (const SnapshotHeader*)base; }
+    const SnapshotSection* table() const { return (const SnapshotSection*)(base + sizeof(SnapshotHeader)); }
+    
+    const SnapshotSection* find(const char* tag) const {
+        uint32_t t = snapshotTag(tag);
+        for (uint32_t i = 0; i < header()->sectionCount; i++) {
+            if (table()[i].tag == t) return &table()[i];
+        }
+        return nullptr;
+    }
+    
+    bool mapFile(const std::string& path) {
+#if defined(_WIN32)
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) return false;
+        size = (size_t)file.tellg();
+        buffer.resize((size + 7) / 8);
+        file.seekg(0);
+        if (!file.read((char*)buffer.data(), size)) return false;
+        base = (const char*)buffer.data();
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        void* p = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            size = (size_t)st.st_size;
+            p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        base = (const char*)p;
+        return true;
+#endif
+    }
+    
+    bool validate() const {
+        if (size < sizeof(SnapshotHeader)) return false;
+        const SnapshotHeader* h = header();
+        if (memcmp(h->magic, SNAPSHOT_MAGIC, sizeof(h->magic)) != 0) return false;
+        if (h->version != SNAPSHOT_VERSION || h->fileSize != size) return false;
+        
+        uint64_t tableBytes = (uint64_t)h->sectionCount * sizeof(SnapshotSection);
+        if (tableBytes > size - sizeof(SnapshotHeader)) return false;
+        if (snapshotChecksum(table(), (size_t)tableBytes) != h->tableChecksum) return false;
+        
+        for (uint32_t i = 0; i < h->sectionCount; i++) {
+            const SnapshotSection& s = table()[i];
+            if (s.offset % 8 != 0 || s.offset > size || s.elemSize == 0) return false;
+            if (s.count > (size - s.offset) / s.elemSize) return false;
+        }
+        return true;
+    }
+};
+
+// ============ BACKGROUND CHECKPOINTS ============
+
+// Writes a snapshot on a worker thread so the game never waits on disk.
+// done(ok) runs on that worker thread once the saver is free again, so
+// whatever it triggers can save straight away (it must not call save()
+// itself, from the worker).
+class BackgroundSaver {
+public:
+    ~BackgroundSaver() { wait(); }
+    
+    // False if the previous checkpoint is still being written
+    bool save(SnapshotWriter writer, std::string path, std::function<void(bool)> done = nullptr) {
+        if (busy.load(std::memory_order_acquire)) return false;
+        wait();
+        busy.store(true, std::memory_order_release);
+        worker = std::thread(&BackgroundSaver::run, this, std::move(writer), std::move(path), std::move(done));
+        return true;
+    }
+    
+    bool saving() const { return busy.load(std::memory_order_acquire); }
+    
+    void wait() {
+        if (worker.joinable()) worker.join();
+    }
+    
+private:
+    std::thread worker;
+    std::atomic<bool> busy{false};
+    
+    void run(SnapshotWriter writer, std::string path, std::function<void(bool)> done) {
+        PROFILE_ZONE("snapshot write");
+        bool ok = writer.writeFile(path);
+        busy.store(false, std::memory_order_release);
+        if (done) done(ok);
+    }
+};
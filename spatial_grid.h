@@ -0,0 +1,98 @@
+// spatial_grid.h
+// Uniform grid over 2D points for radius queries (room hit-testing)
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <algorithm>
+
+// ============ SPATIAL GRID ============
+
+// Points are bucketed into square cells, stored CSR-style: the ids in cell c
+// live in ids[cellStart[c] .. cellStart[c+1]). A query only looks at the
+// cells its box overlaps, so cost depends on local density, not map size.
+//
+// The grid keeps no reference to the points; queries take the same
+// vector build() was given, so copying or moving its owner is safe.
+class SpatialGrid {
+public:
+    static const size_t CELLS_PER_POINT = 4;
+    
+    // cellSize should be about the query radius or larger. Cells grow past
+    // it when the points are spread so thin that the grid would need more
+    // than CELLS_PER_POINT cells per point.
+    void build(const std::vector<std::pair<int, int>>& points, int cellSize) {
+        cell = std::max(1, cellSize);
+        cols = rows = 0;
+        cellStart.clear();
+        ids.clear();
+        if (points.empty()) return;
+        
+        minX = maxX = points[0].first;
+        minY = maxY = points[0].second;
+        for (auto& p : points) {
+            minX = std::min(minX, p.first);
+            maxX = std::max(maxX, p.first);
+            minY = std::min(minY, p.second);
+            maxY = std::max(maxY, p.second);
+        }
+        // 64-bit: the span of two ints can exceed INT_MAX
+        int64_t spanX = (int64_t)maxX - minX;
+        int64_t spanY = (int64_t)maxY - minY;
+        uint64_t maxCells = CELLS_PER_POINT * points.size();
+        while ((uint64_t)(spanX / cell + 1) * (uint64_t)(spanY / cell + 1) > maxCells) cell *= 2;
+        cols = spanX / cell + 1;
+        rows = spanY / cell + 1;
+        
+        // Counting sort by cell
+        cellStart.assign((size_t)(cols * rows) + 1, 0);
+        for (auto& p : points) cellStart[cellOf(p.first, p.second) + 1]++;
+        for (size_t c = 1; c < cellStart.size(); c++) cellStart[c] += cellStart[c - 1];
+        
+        ids.resize(points.size());
+        std::vector<uint32_t> cursor(cellStart.begin(), cellStart.end() - 1);
+        for (uint32_t i = 0; i < points.size(); i++) {
+            ids[cursor[cellOf(points[i].first, points[i].second)]++] = i;
+        }
+    }
+    
+    // Calls fn(id, squaredDistance) for every point within radius of (x, y);
+    // points must be the vector the grid was built from
+    template <class Fn>
+    void forEachNear(const std::vector<std::pair<int, int>>& points, int x, int y, int radius, Fn fn) const {
+        if (ids.empty()) return;
+        int64_t cx0 = std::max<int64_t>(0, floorDiv((int64_t)x - radius - minX));
+        int64_t cy0 = std::max<int64_t>(0, floorDiv((int64_t)y - radius - minY));
+        int64_t cx1 = std::min(cols - 1, floorDiv((int64_t)x + radius - minX));
+        int64_t cy1 = std::min(rows - 1, floorDiv((int64_t)y + radius - minY));
+        long long r2 = (long long)radius * radius;
+        
+        for (int64_t cy = cy0; cy <= cy1; cy++) {
+            for (int64_t cx = cx0; cx <= cx1; cx++) {
+                size_t c = (size_t)(cy * cols + cx);
+                for (uint32_t k = cellStart[c]; k < cellStart[c + 1]; k++) {
+                    uint32_t id = ids[k];
+                    long long dx = (long long)x - points[id].first;
+                    long long dy = (long long)y - points[id].second;
+                    long long d2 = dx * dx + dy * dy;
+                    if (d2 < r2) fn(id, d2);
+                }
+            }
+        }
+    }
+    
+private:
+    int64_t cell = 1;
+    int64_t cols = 0, rows = 0;
+    int minX = 0, minY = 0, maxX = 0, maxY = 0;
+    std::vector<uint32_t> cellStart; // size cols * rows + 1
+    std::vector<uint32_t> ids;       // point ids grouped by cell
+    
+    size_t cellOf(int x, int y) const {
+        return (size_t)(((int64_t)y - minY) / cell * cols + ((int64_t)x - minX) / cell);
+    }
+    
+    // Rounds toward negative infinity so queries left of the grid clamp right
+    int64_t floorDiv(int64_t v) const { return v >= 0 ? v / cell : -((-v + cell - 1) / cell); }
+};
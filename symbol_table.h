@@ -0,0 +1,75 @@
+// symbol_table.h
+// Global string interning: names become dense 32-bit ids, hashed once
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+typedef uint32_t Symbol;
+
+// ============ SYMBOL TABLE ============
+
+// Each distinct name is stored once and gets the next id. After that,
+// code passes ids around and compares or indexes with plain integers.
+class SymbolTable {
+public:
+    static constexpr Symbol NONE = 0xFFFFFFFFu;
+    
+    Symbol intern(const std::string& name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        Symbol id = (Symbol)strings.size();
+        strings.push_back(name);
+        ids.emplace(name, id);
+        return id;
+    }
+    
+    // NONE if the name was never interned
+    Symbol find(const std::string& name) const {
+        auto it = ids.find(name);
+        return it == ids.end() ? NONE : it->second;
+    }
+    
+    const std::string& name(Symbol id) const { return strings[id]; }
+    size_t size() const { return strings.size(); }
+    
+private:
+    std::vector<std::string> strings;             // id -> name
+    std::unordered_map<std::string, Symbol> ids;  // name -> id
+};
+
+// The one table shared by every subsystem, so ids agree across them
+inline SymbolTable& symbols() {
+    static SymbolTable table;
+    return table;
+}
+
+// ============ SYMBOL MAP ============
+
+// Flat map keyed by Symbol: a vector indexed by id that grows on write.
+// Lookups are an index, never a hash or a string compare.
+template <class T>
+class SymbolMap {
+public:
+    explicit SymbolMap(T missing = T()) : fallback(missing) {}
+    
+    T& operator[](Symbol id) {
+        if (id >= values.size()) values.resize(id + 1, fallback);
+        return values[id];
+    }
+    
+    // Value for id, or the fallback if it was never set
+    T get(Symbol id) const { return id < values.size() ? values[id] : fallback; }
+    
+    // One past the highest id ever written
+    size_t size() const { return values.size(); }
+    
+    void clear() { values.clear(); }
+    
+private:
+    std::vector<T> values;
+    T fallback;
+};
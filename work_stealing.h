@@ -0,0 +1,146 @@
+// work_stealing.h
+// Persistent thread pool for index ranges, load-balanced by work stealing
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+
+// ============ WORK-STEALING POOL ============
+
+// run(count, task) calls task(i, thread) for every i in [0, count). Each
+// thread starts on its own contiguous block of indices; one that runs dry
+// steals the back half of another thread's remaining block. Queues are
+// ranges behind a per-thread mutex, taken once per task, so tasks should
+// be chunks of work (a few hundred agents), not single items.
+//
+// The calling thread works too, as thread 0. Threads sleep between runs.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads) : queues(std::max(1u, threads)) {
+        for (auto& q : queues) q.reset(new Queue());
+        for (unsigned t = 1; t < queues.size(); t++) {
+            workers.emplace_back(&WorkStealingPool::workerLoop, this, t);
+        }
+    }
+    
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(wakeLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& w : workers) w.join();
+    }
+    
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    
+    unsigned threadCount() const { return (unsigned)queues.size(); }
+    
+    // Returns once every task has finished
+    void run(uint32_t count, const std::function<void(uint32_t, unsigned)>& task) {
+        if (count == 0) return;
+        job = &task;
+        remaining.store(count, std::memory_order_relaxed);
+        
+        uint32_t threads = (uint32_t)queues.size();
+        for (uint32_t t = 0; t < threads; t++) {
+            std::lock_guard<std::mutex> lock(queues[t]->lock);
+            queues[t]->begin = (uint32_t)((uint64_t)count * t / threads);
+            queues[t]->end = (uint32_t)((uint64_t)count * (t + 1) / threads);
+        }
+        {
+            std::lock_guard<std::mutex> lock(wakeLock);
+            generation++;
+        }
+        wake.notify_all();
+        
+        work(0);
+        std::unique_lock<std::mutex> lock(doneLock);
+        done.wait(lock, [&] { return remaining.load(std::memory_order_acquire) == 0; });
+    }
+    
+private:
+    struct Queue {
+        std::mutex lock;
+        uint32_t begin = 0; // owner pops here
+        uint32_t end = 0;   // thieves take from here
+    };
+    
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    const std::function<void(uint32_t, unsigned)>* job = nullptr;
+    std::atomic<uint32_t> remaining{0};
+    
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    uint64_t generation = 0;
+    bool stopping = false;
+    
+    std::mutex doneLock;
+    std::condition_variable done;
+    
+    void workerLoop(unsigned self) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(wakeLock);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            work(self);
+        }
+    }
+    
+    void work(unsigned self) {
+        uint32_t i;
+        while (popLocal(self, i) || steal(self, i)) {
+            (*job)(i, self);
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(doneLock);
+                done.notify_all();
+            }
+        }
+    }
+    
+    bool popLocal(unsigned self, uint32_t& i) {
+        Queue& q = *queues[self];
+        std::lock_guard<std::mutex> lock(q.lock);
+        if (q.begin == q.end) return false;
+        i = q.begin++;
+        return true;
+    }
+    
+    // Takes the back half of the first non-empty queue after our own,
+    // runs its first index now and keeps the rest as our new block
+    bool steal(unsigned self, uint32_t& i) {
+        unsigned threads = (unsigned)queues.size();
+        for (unsigned k = 1; k < threads; k++) {
+            Queue& victim = *queues[(self + k) % threads];
+            uint32_t first, last;
+            {
+                std::lock_guard<std::mutex> lock(victim.lock);
+                uint32_t left = victim.end - victim.begin;
+                if (left == 0) continue;
+                first = victim.end - (left + 1) / 2;
+                last = victim.end;
+                victim.end = first;
+            }
+            i = first;
+            Queue& mine = *queues[self];
+            std::lock_guard<std::mutex> lock(mine.lock);
+            mine.begin = first + 1;
+            mine.end = last;
+            return true;
+        }
+        return false;
+    }
+};
@@ -0,0 +1,390 @@
+// world_loader.h
+// Streams world files (rooms/locations and roads) straight into a game's
+// graph storage, in fixed-size chunks, without loading the whole file
+#pragma once
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <sys/types.h>
+#include <sys/resource.h>
+#endif
+
+// ============ FILE FORMATS ============
+//
+// Text, one record per line, '#' starts a comment:
+//     N <x> <y> <level> <name>[|<description>]   node; ids count up from 0
+//     E <a> <b> [length]                         undirected road
+//     M <node> <hp>                              monster
+//     T <node>                                   treasure
+//     S <node>                                   start node
+//     G <node>                                   goal node
+// A node must be declared before any record that refers to it.
+//
+// Binary (for big generated maps), all fields little-endian:
+//     WorldBinaryHeader
+//     WorldBinaryNode[nodeCount]
+//     WorldBinaryEdge[edgeCount]
+// Binary nodes carry no names; sinks make one up.
+//
+// A sink is any class with these members, called in file order:
+//     void reserve(uint64_t nodes, uint64_t edges);  // binary files only
+//     void node(int x, int y, int level, const std::string& name, const std::string& desc);
+//     void edge(uint32_t a, uint32_t b, float length); // length < 0: not given
+//     void monster(uint32_t node, int hp);
+//     void treasure(uint32_t node);
+//     void start(uint32_t node);
+//     void goal(uint32_t node);
+
+const char WORLD_BINARY_MAGIC[4] = {'C', 'S', 'W', 'G'};
+const uint32_t WORLD_BINARY_VERSION = 1;
+
+struct WorldBinaryHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t nodeCount;
+    uint64_t edgeCount;
+};
+
+struct WorldBinaryNode {
+    int32_t x;
+    int32_t y;
+    int32_t level;
+};
+
+struct WorldBinaryEdge {
+    uint32_t a;
+    uint32_t b;
+    float length;
+};
+
+struct WorldLoadStats {
+    uint64_t bytes = 0;
+    uint64_t nodes = 0;
+    uint64_t edges = 0;
+    double seconds = 0;
+    size_t peakMemoryKb = 0; // peak resident set of the whole process
+    std::string error;       // empty on success
+    
+    double megabytesPerSecond() const { return seconds > 0 ? bytes / seconds / 1e6 : 0; }
+};
+
+inline size_t peakMemoryKb() {
+#if defined(_WIN32)
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return (size_t)usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    return (size_t)usage.ru_maxrss;        // kilobytes on Linux
+#endif
+#endif
+}
+
+// Bytes in an open file, or -1; the read position is left where it was.
+// ftell returns long, which is 32-bit on Windows, so use the 64-bit calls.
+inline long long fileSize(FILE* f) {
+#if defined(_WIN32)
+    long long at = _ftelli64(f);
+    if (at < 0 || _fseeki64(f, 0, SEEK_END) != 0) return -1;
+    long long size = _ftelli64(f);
+    if (_fseeki64(f, at, SEEK_SET) != 0) return -1;
+#else
+    off_t at = ftello(f);
+    if (at < 0 || fseeko(f, 0, SEEK_END) != 0) return -1;
+    long long size = ftello(f);
+    if (fseeko(f, at, SEEK_SET) != 0) return -1;
+#endif
+    return size;
+}
+
+// ============ TEXT PARSING ============
+
+// Cursor over one line; every read skips leading blanks first
+class WorldLineReader {
+public:
+    WorldLineReader(const char* first, const char* last) : p(first), end(last) {}
+    
+    bool readInt(long long& out) {
+        skipBlanks();
+        bool negative = p < end && *p == '-';
+        if (negative || (p < end && *p == '+')) p++;
+        if (p == end || *p < '0' || *p > '9') return false;
+        long long v = 0;
+        while (p < end && *p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+        out = negative ? -v : v;
+        return true;
+    }
+    
+    // Plain decimals only ("12", "3.75"), which is all world files use
+    bool readFloat(float& out) {
+        long long whole;
+        if (!readInt(whole)) return false;
+        double v = (double)(whole < 0 ? -whole : whole);
+        if (p < end && *p == '.') {
+            double scale = 0.1;
+            for (p++; p < end && *p >= '0' && *p <= '9'; p++, scale *= 0.1) v += (*p - '0') * scale;
+        }
+        out = (float)(whole < 0 ? -v : v);
+        return true;
+    }
+    
+    bool atEnd() {
+        skipBlanks();
+        return p == end;
+    }
+    
+    // Everything left on the line, minus surrounding blanks
+    void rest(const char*& first, const char*& last) {
+        skipBlanks();
+        last = end;
+        while (last > p && (last[-1] == ' ' || last[-1] == '\t')) last--;
+        first = p;
+    }
+    
+private:
+    const char* p;
+    const char* end;
+    
+    void skipBlanks() {
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+    }
+};
+
+template <class Sink>
+class WorldTextParser {
+public:
+    WorldTextParser(Sink& s, WorldLoadStats& st) : sink(s), stats(st) {}
+    
+    bool parseLine(const char* first, const char* last) {
+        lineNumber++;
+        if (last > first && last[-1] == '\r') last--;
+        WorldLineReader line(first, last);
+        if (line.atEnd()) return true;
+        
+        const char* kind;
+        const char* kindEnd;
+        line.rest(kind, kindEnd);
+        if (*kind == '#') return true;
+        WorldLineReader fields(kind + 1, last);
+        
+        long long a, b, c;
+        float length;
+        switch (*kind) {
+        case 'N': {
+            if (!fields.readInt(a) || !fields.readInt(b) || !fields.readInt(c)) return fail("bad node");
+            const char* text;
+            const char* textEnd;
+            fields.rest(text, textEnd);
+            const char* bar = (const char*)memchr(text, '|', textEnd - text);
+            const char* nameEnd = bar ? bar : textEnd;
+            name.assign(text, nameEnd);
+            desc.assign(bar ? bar + 1 : textEnd, textEnd);
+            sink.node((int)a, (int)b, (int)c, name, desc);
+            stats.nodes++;
+            return true;
+        }
+        case 'E':
+            if (!fields.readInt(a) || !fields.readInt(b) || !isNode(a) || !isNode(b)) return fail("bad edge");
+            if (!fields.readFloat(length)) length = -1;
+            sink.edge((uint32_t)a, (uint32_t)b, length);
+            stats.edges++;
+            return true;
+        case 'M':
+            if (!fields.readInt(a) || !fields.readInt(b) || !isNode(a)) return fail("bad monster");
+            sink.monster((uint32_t)a, (int)b);
+            return true;
+        case 'T':
+        case 'S':
+        case 'G':
+            if (!fields.readInt(a) || !isNode(a)) return fail("bad node reference");
+            if (*kind == 'T') sink.treasure((uint32_t)a);
+            else if (*kind == 'S') sink.start((uint32_t)a);
+            else sink.goal((uint32_t)a);
+            return true;
+        default:
+            return fail("unknown record");
+        }
+    }
+    
+private:
+    Sink& sink;
+    WorldLoadStats& stats;
+    uint64_t lineNumber = 0;
+    std::string name; // reused across lines
+    std::string desc;
+    
+    bool isNode(long long id) const { return id >= 0 && (uint64_t)id < stats.nodes; }
+    
+    bool fail(const char* what) {
+        stats.error = std::string(what) + " on line " + std::to_string(lineNumber);
+        return false;
+    }
+};
+
+// ============ LOADING ============
+
+const size_t WORLD_CHUNK = 1 << 20; // bytes read per fread
+
+template <class Sink>
+bool loadWorldText(FILE* f, Sink& sink, WorldLoadStats& stats) {
+    WorldTextParser<Sink> parser(sink, stats);
+    std::vector<char> buf(WORLD_CHUNK);
+    size_t carry = 0; // partial line kept from the previous chunk
+    
+    while (true) {
+        if (carry == buf.size()) buf.resize(buf.size() * 2); // line longer than a chunk
+        size_t got = fread(buf.data() + carry, 1, buf.size() - carry, f);
+        stats.bytes += got;
+        size_t filled = carry + got;
+        if (got == 0) {
+            return carry == 0 || parser.parseLine(buf.data(), buf.data() + carry);
+        }
+        
+        const char* line = buf.data();
+        const char* end = buf.data() + filled;
+        while (const char* nl = (const char*)memchr(line, '\n', end - line)) {
+            if (!parser.parseLine(line, nl)) return false;
+            line = nl + 1;
+        }
+        carry = end - line;
+        memmove(buf.data(), line, carry);
+    }
+}
+
+template <class Sink>
+bool loadWorldBinary(FILE* f, Sink& sink, WorldLoadStats& stats) {
+    WorldBinaryHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 || header.version != WORLD_BINARY_VERSION) {
+        stats.error = "bad binary header";
+        return false;
+    }
+    stats.bytes += sizeof(header);
+    
+    // The counts must fit in what is actually there before anything is
+    // reserved for them, or a corrupt header could ask for any amount
+    long long size = fileSize(f);
+    if (size < (long long)sizeof(header)) {
+        stats.error = "cannot size file";
+        return false;
+    }
+    uint64_t body = (uint64_t)size - sizeof(header);
+    if (header.nodeCount > body / sizeof(WorldBinaryNode)
+        || header.edgeCount > (body - header.nodeCount * sizeof(WorldBinaryNode)) / sizeof(WorldBinaryEdge)) {
+        stats.error = "node and edge counts do not fit the file";
+        return false;
+    }
+    sink.reserve(header.nodeCount, header.edgeCount);
+    
+    const std::string noText;
+    std::vector<WorldBinaryNode> nodes(WORLD_CHUNK / sizeof(WorldBinaryNode));
+    for (uint64_t left = header.nodeCount; left > 0;) {
+        size_t want = (size_t)std::min<uint64_t>(left, nodes.size());
+        if (fread(nodes.data(), sizeof(WorldBinaryNode), want, f) != want) {
+            stats.error = "truncated node list";
+            return false;
+        }
+        for (size_t i = 0; i < want; i++) sink.node(nodes[i].x, nodes[i].y, nodes[i].level, noText, noText);
+        stats.bytes += want * sizeof(WorldBinaryNode);
+        stats.nodes += want;
+        left -= want;
+    }
+    
+    std::vector<WorldBinaryEdge> edges(WORLD_CHUNK / sizeof(WorldBinaryEdge));
+    for (uint64_t left = header.edgeCount; left > 0;) {
+        size_t want = (size_t)std::min<uint64_t>(left, edges.size());
+        if (fread(edges.data(), sizeof(WorldBinaryEdge), want, f) != want) {
+            stats.error = "truncated edge list";
+            return false;
+        }
+        for (size_t i = 0; i < want; i++) {
+            const WorldBinaryEdge& e = edges[i];
+            if (e.a >= stats.nodes || e.b >= stats.nodes) {
+                stats.error = "edge refers to a missing node";
+                return false;
+            }
+            sink.edge(e.a, e.b, e.length);
+        }
+        stats.bytes += want * sizeof(WorldBinaryEdge);
+        stats.edges += want;
+        left -= want;
+    }
+    return true;
+}
+
+// Text or binary, told apart by the magic bytes. A world with no nodes
+// fails too. On failure stats.error says why; the sink may have been
+// partly filled.
+template <class Sink>
+bool loadWorld(const std::string& path, Sink& sink, WorldLoadStats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    stats = WorldLoadStats();
+    
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        stats.error = "cannot open " + path;
+        return false;
+    }
+    char magic[4] = {0, 0, 0, 0};
+    size_t got = fread(magic, 1, 4, f);
+    bool binary = got == 4 && memcmp(magic, WORLD_BINARY_MAGIC, 4) == 0;
+    rewind(f);
+    
+    bool ok = binary ? loadWorldBinary(f, sink, stats) : loadWorldText(f, sink, stats);
+    fclose(f);
+    if (ok && stats.nodes == 0) {
+        stats.error = "no nodes";
+        ok = false;
+    }
+    
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.peakMemoryKb = peakMemoryKb();
+    return ok;
+}
+
+// For built-in worlds compiled into the game
+template <class Sink>
+bool parseWorldText(const char* text, Sink& sink, WorldLoadStats& stats) {
+    stats = WorldLoadStats();
+    WorldTextParser<Sink> parser(sink, stats);
+    const char* line = text;
+    const char* end = text + strlen(text);
+    stats.bytes = end - text;
+    while (line < end) {
+        const char* nl = (const char*)memchr(line, '\n', end - line);
+        if (!nl) nl = end;
+        if (!parser.parseLine(line, nl)) return false;
+        line = nl + 1;
+    }
+    if (stats.nodes == 0) {
+        stats.error = "no nodes";
+        return false;
+    }
+    return true;
+}
+
+// ============ WRITING ============
+
+inline bool writeWorldBinary(const std::string& path, const std::vector<WorldBinaryNode>& nodes,
+                             const std::vector<WorldBinaryEdge>& edges) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    WorldBinaryHeader header;
+    memcpy(header.magic, WORLD_BINARY_MAGIC, 4);
+    header.version = WORLD_BINARY_VERSION;
+    header.nodeCount = nodes.size();
+    header.edgeCount = edges.size();
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+        && fwrite(nodes.data(), sizeof(WorldBinaryNode), nodes.size(), f) == nodes.size()
+        && fwrite(edges.data(), sizeof(WorldBinaryEdge), edges.size(), f) == edges.size();
+    return fclose(f) == 0 && ok;
+}
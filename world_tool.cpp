@@ -0,0 +1,158 @@
+// world_tool.cpp
+// Generates, converts and benchmarks world files for both games
+// (format in world_loader.h)
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "graph_core.h"
+#include "rng.h"
+#include "world_loader.h"
+
+using namespace std;
+
+// ============ SINKS ============
+
+// Keeps plain node and edge records, for conversion to binary
+struct RecordSink {
+    vector<WorldBinaryNode> nodes;
+    vector<WorldBinaryEdge> edges;
+    
+    void reserve(uint64_t n, uint64_t e) {
+        nodes.reserve(n);
+        edges.reserve(e);
+    }
+    void node(int x, int y, int level, const string&, const string&) { nodes.push_back({x, y, level}); }
+    void edge(uint32_t a, uint32_t b, float length) { edges.push_back({a, b, length}); }
+    void monster(uint32_t, int) {}
+    void treasure(uint32_t) {}
+    void start(uint32_t) {}
+    void goal(uint32_t) {}
+};
+
+// Loads straight into graph storage the way the games do, names included
+struct GraphSink {
+    vector<string> names;
+    vector<pair<int, int>> positions;
+    GraphBuilder builder;
+    
+    void reserve(uint64_t n, uint64_t e) {
+        names.reserve(n);
+        positions.reserve(n);
+        builder.reserve(e);
+    }
+    void node(int x, int y, int, const string& name, const string&) {
+        names.push_back(name);
+        positions.push_back({x, y});
+    }
+    void edge(uint32_t a, uint32_t b, float length) { builder.addEdge(a, b, length < 0 ? 1.0f : length); }
+    void monster(uint32_t, int) {}
+    void treasure(uint32_t) {}
+    void start(uint32_t) {}
+    void goal(uint32_t) {}
+};
+
+// ============ COMMANDS ============
+
+// Rooms on a square grid, each joined to its right and lower neighbour,
+// plus one random shortcut per ten rooms. Every seventh room has a monster.
+int generate(long long rooms, const string& out, bool binary, uint64_t seed) {
+    Rng rng(seed);
+    long long side = (long long)ceil(sqrt((double)rooms));
+    const int SPACING = 60;
+    
+    vector<WorldBinaryNode> nodes;
+    vector<WorldBinaryEdge> edges;
+    nodes.reserve(rooms);
+    for (long long i = 0; i < rooms; i++) {
+        nodes.push_back({(int)(i % side) * SPACING + 100, (int)(i / side) * SPACING + 100, 1 + (int)rng.below(7)});
+    }
+    auto link = [&](long long a, long long b) {
+        float dx = (float)(nodes[a].x - nodes[b].x);
+        float dy = (float)(nodes[a].y - nodes[b].y);
+        edges.push_back({(uint32_t)a, (uint32_t)b, sqrt(dx * dx + dy * dy)});
+    };
+    for (long long i = 0; i < rooms; i++) {
+        if ((i + 1) % side != 0 && i + 1 < rooms) link(i, i + 1);
+        if (i + side < rooms) link(i, i + side);
+        if (i % 10 == 9) link(i, rng.below((uint32_t)rooms));
+    }
+    
+    if (binary) {
+        if (!writeWorldBinary(out, nodes, edges)) return 1;
+    } else {
+        FILE* f = fopen(out.c_str(), "w");
+        if (!f) return 1;
+        for (long long i = 0; i < rooms; i++) {
+            fprintf(f, "N %d %d %d Room %lld\n", nodes[i].x, nodes[i].y, nodes[i].level, i);
+        }
+        for (auto& e : edges) fprintf(f, "E %u %u %.1f\n", e.a, e.b, e.length);
+        for (long long i = 3; i < rooms; i += 7) fprintf(f, "M %lld %d\n", i, 20 + nodes[i].level * 10);
+        fprintf(f, "S 0\nG %lld\n", rooms - 1);
+        if (fclose(f) != 0) return 1;
+    }
+    printf("Wrote %lld rooms, %zu edges to %s\n", rooms, edges.size(), out.c_str());
+    return 0;
+}
+
+int convert(const string& in, const string& out) {
+    RecordSink sink;
+    WorldLoadStats stats;
+    if (!loadWorld(in, sink, stats)) {
+        fprintf(stderr, "%s: %s\n", in.c_str(), stats.error.c_str());
+        return 1;
+    }
+    if (!writeWorldBinary(out, sink.nodes, sink.edges)) return 1;
+    printf("Converted %zu nodes, %zu edges to %s\n", sink.nodes.size(), sink.edges.size(), out.c_str());
+    return 0;
+}
+
+int stats(const string& path) {
+    GraphSink sink;
+    WorldLoadStats load;
+    if (!loadWorld(path, sink, load)) {
+        fprintf(stderr, "%s: %s\n", path.c_str(), load.error.c_str());
+        return 1;
+    }
+    CsrGraph graph = sink.builder.freeze((uint32_t)sink.names.size());
+    printf("%s: %llu nodes, %llu edges, %.1f MB\n", path.c_str(),
+           (unsigned long long)load.nodes, (unsigned long long)load.edges, load.bytes / 1e6);
+    printf("Loaded in %.3f s (%.1f MB/s), peak memory %.1f MB\n",
+           load.seconds, load.megabytesPerSecond(), load.peakMemoryKb / 1024.0);
+    printf("Frozen graph: %u nodes, %zu arcs\n", graph.nodeCount(), graph.arcCount());
+    return 0;
+}
+
+// ============ COMMAND LINE ============
+
+void printUsage() {
+    cout << "Usage: world_tool gen ROOMS OUT [--binary] [--seed S]\n"
+         << "       world_tool convert IN OUT      text or binary in, binary out\n"
+         << "       world_tool stats FILE          load time and memory\n";
+}
+
+int main(int argc, char* argv[]) {
+    string cmd = argc > 1 ? argv[1] : "";
+    if (cmd == "gen" && argc >= 4) {
+        bool binary = false;
+        uint64_t seed = 12345;
+        for (int i = 4; i < argc; i++) {
+            if (strcmp(argv[i], "--binary") == 0) binary = true;
+            else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], nullptr, 10);
+        }
+        long long rooms = atoll(argv[2]);
+        if (rooms > 0 && rooms < (1ll << 32)) return generate(rooms, argv[3], binary, seed);
+    } else if (cmd == "convert" && argc == 4) {
+        return convert(argv[2], argv[3]);
+    } else if (cmd == "stats" && argc == 3) {
+        return stats(argv[2]);
+    }
+    printUsage();
+    return 1;
+}
+
+// Compile with: g++ -O3 -std=c++17 world_tool.cpp -o world_tool